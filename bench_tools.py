@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""
+Microbenchmark the tool layer: every tool schema against every benchmark
+binary, run through the sandbox runners with no tool cache or index.
+
+Each (runner, tool, binary) command runs --iterations times on a fresh
+runner. The first run is reported as cold (for the pooled runner that
+includes the container start) and the rest as warm. Results are compared
+with a stored baseline, and the script exits 1 when a tool's warm p50
+regressed by more than --threshold.
+
+Usage:
+    python bench_tools.py                          # subprocess runner, binaries/ + binaries_macho/
+    python bench_tools.py --runner subprocess docker pooled -n 10
+    python bench_tools.py --tools objdump readelf --save-baseline
+    python bench_tools.py binaries/level1_TCPServer --report bench.json
+"""
+
+import argparse
+import json
+import resource
+import sys
+import time
+from datetime import datetime, timezone
+from pathlib import Path
+
+from harness.config import BenchmarkConfig
+from harness.index import tool_environment
+from harness.timing import percentile
+from harness.tools import ToolExecutor, get_tool_schemas_for_format
+
+PROJECT_ROOT = Path(__file__).resolve().parent
+BASELINE_PATH = PROJECT_ROOT / ".cache" / "tool_bench_baseline.json"
+BASELINE_VERSION = 1
+
+RUNNERS = {
+    # name: (use_docker, pooled_sandbox)
+    "subprocess": (False, False),
+    "docker": (True, False),
+    "pooled": (True, True),
+}
+
+# One representative (usually the heaviest) call per tool
+BENCH_INPUTS: dict[str, dict] = {
+    "file": {},
+    "strings": {},
+    "section_strings": {},
+    "readelf": {"flags": "-a"},
+    "objdump": {"flags": "-d"},
+    "disasm": {"symbol": "main"},
+    "nm": {},
+    "hexdump": {"length": 4096},
+    "xxd": {"length": 4096},
+    "entropy": {},
+    "pefile": {"flags": "all"},
+}
+
+_MAGIC_FORMATS = [
+    (b"\x7fELF", "ELF64"),
+    (b"\xcf\xfa\xed\xfe", "Mach-O"),
+    (b"\xce\xfa\xed\xfe", "Mach-O"),
+    (b"MZ", "PE32"),
+]
+
+
+def binary_format(path: Path) -> str | None:
+    with open(path, "rb") as f:
+        magic = f.read(4)
+    for prefix, fmt in _MAGIC_FORMATS:
+        if magic.startswith(prefix):
+            return fmt
+    return None
+
+
+def default_binaries() -> list[Path]:
+    """The tasks.json binaries, from binaries/ and (if built) binaries_macho/."""
+    with open(PROJECT_ROOT / "tasks.json") as f:
+        names = [t["binary_name"] for t in json.load(f)["tasks"]]
+    return [
+        PROJECT_ROOT / d / name
+        for d in ("binaries", "binaries_macho")
+        for name in names
+        if (PROJECT_ROOT / d / name).is_file()
+    ]
+
+
+def bench_tool(
+    config: BenchmarkConfig, binary: Path, tool: str, iterations: int,
+) -> dict | None:
+    """Time one tool on one binary; None if the tool cannot run on it."""
+    executor = ToolExecutor(config, binary)
+    try:
+        try:
+            cmd = executor._build_command(tool, {"path": binary.name, **BENCH_INPUTS.get(tool, {})})
+        except (ValueError, FileNotFoundError):
+            return None  # e.g. entropy without the native helper
+        seconds, rss, failures = [], [], 0
+        result = None
+        for _ in range(iterations):
+            start = time.monotonic()
+            result = executor._run(cmd)
+            seconds.append(time.monotonic() - start)
+            rss.append(result.max_rss_kb)
+            failures += result.timed_out or (result.returncode != 0 and not result.stopped_early)
+        return {
+            "seconds": seconds,
+            "output_bytes": result.output_bytes,
+            "max_rss_kb": max(rss),
+            "failures": failures,
+        }
+    finally:
+        executor.close()
+
+
+def rss_floor_kb() -> int:
+    """This process's peak RSS: a spawned tool's measured peak never reads lower."""
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return rss // 1024 if sys.platform == "darwin" else rss
+
+
+def summarize_runs(runs: list[dict]) -> dict:
+    """Per (runner, tool): cold/warm latency percentiles over all binaries, sizes and RSS."""
+    cold = sorted(r["seconds"][0] for r in runs)
+    warm = sorted(s for r in runs for s in r["seconds"][1:])
+
+    def pct(values: list[float], qs: tuple[int, ...]) -> dict:
+        return {f"p{q}": round(percentile(values, q), 5) for q in qs} if values else {}
+
+    return {
+        "binaries": len(runs),
+        "cold": pct(cold, (50, 95)),
+        "warm": pct(warm, (50, 95, 99)),
+        "output_bytes_mean": round(sum(r["output_bytes"] for r in runs) / len(runs)),
+        "max_rss_kb": max(r["max_rss_kb"] for r in runs),
+        "rss_floor_kb": rss_floor_kb(),
+        "failures": sum(r["failures"] for r in runs),
+    }
+
+
+def compare(
+    results: dict, baseline: dict, threshold: float, min_delta: float,
+) -> tuple[dict[str, float | None], list[str]]:
+    """Warm p50 change vs the baseline per key (None when not in it); flags regressions."""
+    changes = {}
+    for key, summary in results.items():
+        base = baseline.get("results", {}).get(key, {}).get("warm", {}).get("p50")
+        cur = summary["warm"].get("p50")
+        changes[key] = None if not base or cur is None else (cur - base) / base
+    regressions = [
+        key for key, change in changes.items()
+        if change is not None and change > threshold
+        and results[key]["warm"]["p50"] - baseline["results"][key]["warm"]["p50"] > min_delta
+    ]
+    return changes, regressions
+
+
+def print_table(results: dict, changes: dict, regressions: list[str]) -> None:
+    def ms(summary: dict, phase: str, q: str) -> str:
+        value = summary[phase].get(q)
+        return f"{value * 1000:9.1f}" if value is not None else f"{'-':>9}"
+
+    print(f"{'runner:tool':<22} {'bins':>4} {'cold p50':>9} {'warm p50':>9} {'warm p95':>9} "
+          f"{'warm p99':>9} {'out KB':>8} {'RSS MB':>7} {'vs base':>8}")
+    for key, s in results.items():
+        change = changes.get(key)
+        delta = f"{change:+7.0%}" if change is not None else f"{'new':>7}"
+        mark = " !" if key in regressions else ""
+        if not s["max_rss_kb"]:
+            rss = "-"
+        elif s["max_rss_kb"] <= s["rss_floor_kb"]:
+            rss = f"<{s['rss_floor_kb'] / 1024:.0f}"   # below what can be told from the harness's own
+        else:
+            rss = f"{s['max_rss_kb'] / 1024:.1f}"
+        print(f"{key:<22} {s['binaries']:>4} {ms(s, 'cold', 'p50')} {ms(s, 'warm', 'p50')} "
+              f"{ms(s, 'warm', 'p95')} {ms(s, 'warm', 'p99')} {s['output_bytes_mean'] / 1024:8.1f} "
+              f"{rss:>7} {delta:>8}{mark}"
+              + (f"  ({s['failures']} failed)" if s["failures"] else ""))
+    print("(milliseconds; RSS is the docker client's for the docker runners)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark tool latency through the sandbox runners")
+    parser.add_argument("paths", nargs="*", help="Binaries (default: tasks.json binaries, ELF and Mach-O)")
+    parser.add_argument("--runner", nargs="+", choices=sorted(RUNNERS), default=["subprocess"],
+                        help="Runners to benchmark (default: subprocess)")
+    parser.add_argument("--image", default="agentre-bench-tools:latest", help="Tools Docker image")
+    parser.add_argument("--tools", nargs="+", help="Only these tools (default: every tool for each format)")
+    parser.add_argument("-n", "--iterations", type=int, default=5, help="Runs per tool and binary (default: 5)")
+    parser.add_argument("--max-output-chars", type=int, default=BenchmarkConfig.max_output_chars,
+                        help="Runner output limit, as in a benchmark run (default: %(default)s)")
+    parser.add_argument("--baseline", type=Path, default=BASELINE_PATH, help="Baseline file (default: %(default)s)")
+    parser.add_argument("--save-baseline", action="store_true", help="Store these results as the baseline")
+    parser.add_argument("--threshold", type=float, default=0.2,
+                        help="Fail when a warm p50 is this fraction slower than the baseline (default: 0.2)")
+    parser.add_argument("--min-delta-ms", type=float, default=5.0,
+                        help="Ignore regressions smaller than this many ms (default: 5)")
+    parser.add_argument("--no-analysis-server", action="store_true",
+                        help="Run pefile / entropy as one process per call, not on the resident analyzer")
+    parser.add_argument("--report", type=Path, help="Also write the results as JSON here")
+    args = parser.parse_args()
+
+    binaries = [Path(p).resolve() for p in args.paths] or default_binaries()
+    binaries = [(b, fmt) for b in binaries if b.is_file() and (fmt := binary_format(b))]
+    if not binaries:
+        print("No binaries found; build them first.")
+        sys.exit(1)
+    iterations = max(2, args.iterations)   # one cold run plus at least one warm
+
+    results: dict[str, dict] = {}
+    environments: dict[str, str] = {}
+    for runner in args.runner:
+        use_docker, pooled = RUNNERS[runner]
+        environments[runner] = tool_environment(use_docker, args.image)
+        print(f"=== {runner}: {len(binaries)} binaries x {iterations} runs ({environments[runner]}) ===")
+        runs: dict[str, list[dict]] = {}
+        for binary, fmt in binaries:
+            config = BenchmarkConfig(
+                project_root=PROJECT_ROOT,
+                workspace_dir=binary.parent,
+                ground_truths_dir=PROJECT_ROOT / "ground_truths",
+                docker_image=args.image,
+                use_docker=use_docker,
+                pooled_sandbox=pooled,
+                tool_cache_enabled=False,
+                binary_index_enabled=False,
+                analysis_server=not args.no_analysis_server,
+                max_output_chars=args.max_output_chars,
+            )
+            tools = [s["name"] for s in get_tool_schemas_for_format(fmt, include_final_answer=False)]
+            for tool in tools:
+                if args.tools and tool not in args.tools:
+                    continue
+                run = bench_tool(config, binary, tool, iterations)
+                if run is not None:
+                    runs.setdefault(tool, []).append(run)
+        for tool, tool_runs in sorted(runs.items()):
+            results[f"{runner}:{tool}"] = summarize_runs(tool_runs)
+
+    baseline = {}
+    if args.baseline.is_file():
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get("version") != BASELINE_VERSION:
+            print(f"Ignoring {args.baseline}: baseline version {baseline.get('version')}")
+            baseline = {}
+        for runner, env in environments.items():
+            if baseline and baseline.get("environments", {}).get(runner, env) != env:
+                print(f"Note: {runner} tool environment differs from the baseline's")
+
+    changes, regressions = compare(results, baseline, args.threshold, args.min_delta_ms / 1000) \
+        if baseline else ({}, [])
+    print()
+    print_table(results, changes, regressions)
+
+    if args.report:
+        args.report.parent.mkdir(parents=True, exist_ok=True)
+        with open(args.report, "w") as f:
+            json.dump({"environments": environments, "iterations": iterations, "results": results,
+                       "change_vs_baseline": changes, "regressions": regressions}, f, indent=2)
+
+    if args.save_baseline:
+        # Merged, so benchmarking a subset of runners or tools keeps the other entries
+        merged = {
+            "version": BASELINE_VERSION,
+            "created": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+            "environments": {**baseline.get("environments", {}), **environments},
+            "results": {**baseline.get("results", {}), **results},
+        }
+        args.baseline.parent.mkdir(parents=True, exist_ok=True)
+        with open(args.baseline, "w") as f:
+            json.dump(merged, f, indent=2)
+        print(f"Baseline saved to {args.baseline}")
+    elif regressions:
+        print(f"\n{len(regressions)} regression(s) above {args.threshold:.0%}: {', '.join(regressions)}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
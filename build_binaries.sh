@@ -3,21 +3,42 @@
 # build_binaries.sh — Compile all 13 C samples to ELF64 x86-64 binaries.
 #
 # On Linux x86-64: uses local gcc directly (no Docker needed).
-# On macOS / other: uses Docker with --platform linux/amd64 to cross-compile.
+# On macOS / other: uses Docker with --platform linux/amd64 to cross-compile,
+# in a single container shared by all samples.
 #
-# Output: binaries/ directory with 13 ELF64 executables.
+# Samples compile in parallel (-j N, default: CPU count). Each artifact is
+# cached under .cache/builds/ by (source hash, toolchain, flags), so unchanged
+# samples are copied instead of rebuilt; --force ignores the cache.
+#
+# Output: binaries/ directory with 13 ELF64 executables, plus
+# binaries/build_manifest.json recording what each one was built from.
+#
+# Usage: ./build_binaries.sh [-j N] [--force]
 #
 set -euo pipefail
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 SAMPLES_DIR="$SCRIPT_DIR/samples"
 BINARIES_DIR="$SCRIPT_DIR/binaries"
+CACHE_DIR="$SCRIPT_DIR/.cache/builds"
+MANIFEST="$BINARIES_DIR/build_manifest.json"
 DOCKER_IMAGE="gcc:latest"
 
 # Common compilation flags
 CFLAGS="-O0 -fno-stack-protector -no-pie -z execstack -static"
 
-mkdir -p "$BINARIES_DIR"
+JOBS="$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4)"
+FORCE=false
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -j) JOBS="$2"; shift 2 ;;
+        -j*) JOBS="${1#-j}"; shift ;;
+        --force) FORCE=true; shift ;;
+        *) echo "Usage: $0 [-j N] [--force]"; exit 1 ;;
+    esac
+done
+
+mkdir -p "$BINARIES_DIR" "$CACHE_DIR"
 
 # Detect build mode: local gcc or Docker
 USE_DOCKER=true
@@ -29,14 +50,39 @@ elif ! command -v docker &>/dev/null; then
     exit 1
 fi
 
+sha256() {
+    if command -v sha256sum &>/dev/null; then
+        sha256sum "$@" | cut -d' ' -f1
+    else
+        shasum -a 256 "$@" | cut -d' ' -f1
+    fi
+}
+
+# Identifies the toolchain for cache keys. Static binaries embed libc, so the
+# libc.a hash counts as well as the compiler version.
+TOOLCHAIN_PROBE='gcc --version | head -1; sha256sum "$(gcc -print-file-name=libc.a)" 2>/dev/null | cut -d" " -f1'
+
 echo "=== AgentRE-Bench: Building ELF64 binaries ==="
 echo "Samples dir:  $SAMPLES_DIR"
 echo "Output dir:   $BINARIES_DIR"
 if [ "$USE_DOCKER" = true ]; then
-    echo "Build mode:   Docker ($DOCKER_IMAGE)"
+    echo "Build mode:   Docker ($DOCKER_IMAGE), $JOBS jobs"
     docker pull "$DOCKER_IMAGE" 2>/dev/null || true
+    # One long-lived container for every sample instead of one per sample
+    CONTAINER="agentre-build-$$"
+    docker run -d --rm \
+        --name "$CONTAINER" \
+        --platform linux/amd64 \
+        -v "$SAMPLES_DIR:/src:ro" \
+        -v "$CACHE_DIR:/cache" \
+        -w /src \
+        "$DOCKER_IMAGE" \
+        sleep infinity >/dev/null
+    trap 'docker rm -f "$CONTAINER" >/dev/null 2>&1 || true' EXIT
+    TOOLCHAIN="$(docker exec "$CONTAINER" bash -c "$TOOLCHAIN_PROBE")"
 else
-    echo "Build mode:   Local gcc ($(gcc --version | head -1))"
+    echo "Build mode:   Local gcc ($(gcc --version | head -1)), $JOBS jobs"
+    TOOLCHAIN="$(bash -c "$TOOLCHAIN_PROBE")"
 fi
 echo ""
 
@@ -56,16 +102,57 @@ NAME_MAP["level11_ForkBombReverseShell"]="level11_ForkBombReverseShell"
 NAME_MAP["level12_JIT_Compiled_Shellcode"]="level12_JIT_Compiled_Shellcode"
 NAME_MAP["level13_MetamorphicDropper"]="level13_MetamorphicDropper"
 
-SUCCESS=0
-FAIL=0
+STATUS_DIR="$(mktemp -d)"
+trap 'rm -rf "$STATUS_DIR"; [ -n "${CONTAINER:-}" ] && docker rm -f "$CONTAINER" >/dev/null 2>&1 || true' EXIT
+
+# Compile one sample into the artifact cache (unless already there) and copy
+# it to binaries/. Runs in the background; the result goes to $STATUS_DIR.
+build_one() {
+    local BASENAME="$1" OUTNAME="$2" FLAGS="$3"
+    local SRC_HASH KEY ARTIFACT STATUS LOG=""
+    SRC_HASH="$(sha256 "$SAMPLES_DIR/$BASENAME.c")"
+    KEY="$(printf '%s\n' "elf64-x86_64" "$TOOLCHAIN" "$FLAGS" "$SRC_HASH" | sha256)"
+    ARTIFACT="$CACHE_DIR/$KEY/$OUTNAME"
+
+    if [ "$FORCE" = false ] && [ -f "$ARTIFACT" ]; then
+        STATUS="cached"
+    else
+        mkdir -p "$CACHE_DIR/$KEY"
+        rm -f "$ARTIFACT.partial"
+        if [ "$USE_DOCKER" = true ]; then
+            LOG="$(docker exec "$CONTAINER" \
+                bash -c "gcc $FLAGS -o '/cache/$KEY/$OUTNAME.partial' '/src/$BASENAME.c' -lm 2>&1")" \
+                && STATUS="built" || STATUS="failed"
+        else
+            LOG="$(gcc $FLAGS -o "$ARTIFACT.partial" "$SAMPLES_DIR/$BASENAME.c" -lm 2>&1)" \
+                && STATUS="built" || STATUS="failed"
+        fi
+        # Only complete artifacts enter the cache
+        if [ "$STATUS" = built ]; then
+            mv -f "$ARTIFACT.partial" "$ARTIFACT"
+        fi
+    fi
+    if [ -n "$LOG" ]; then
+        LOG+=$'\n'
+    fi
+
+    if [ "$STATUS" != failed ]; then
+        cp -p "$ARTIFACT" "$BINARIES_DIR/$OUTNAME.tmp" && mv -f "$BINARIES_DIR/$OUTNAME.tmp" "$BINARIES_DIR/$OUTNAME"
+    fi
+
+    case "$STATUS" in
+        cached) printf 'Building %s ... OK (cached)\n' "$OUTNAME" ;;
+        built)  printf 'Building %s ... OK\n%s' "$OUTNAME" "$LOG" ;;
+        *)      printf 'Building %s ... FAILED\n%s' "$OUTNAME" "$LOG" ;;
+    esac
+    printf '%s\t%s\t%s\t%s\t%s\n' "$STATUS" "$BASENAME" "$FLAGS" "$SRC_HASH" "$KEY" > "$STATUS_DIR/$OUTNAME"
+}
 
 for SRC in "$SAMPLES_DIR"/*.c; do
     # Extract base name without extension
     BASENAME="$(basename "$SRC" .c)"
     OUTNAME="${NAME_MAP[$BASENAME]:-$BASENAME}"
 
-    echo -n "Building $OUTNAME ... "
-
     # Level 9 is a shared object — needs -shared -fPIC, must NOT use -static
     EXTRA_FLAGS=""
     BUILD_CFLAGS="$CFLAGS"
@@ -74,38 +161,59 @@ for SRC in "$SAMPLES_DIR"/*.c; do
         BUILD_CFLAGS="${CFLAGS//-static/}"
     fi
 
-    if [ "$USE_DOCKER" = true ]; then
-        # Docker build (macOS / non-x86-64)
-        if docker run --rm \
-            --platform linux/amd64 \
-            -v "$SAMPLES_DIR:/src:ro" \
-            -v "$BINARIES_DIR:/out" \
-            -w /src \
-            "$DOCKER_IMAGE" \
-            bash -c "gcc $BUILD_CFLAGS $EXTRA_FLAGS -o '/out/$OUTNAME' '/src/$BASENAME.c' -lm 2>&1" \
-        ; then
-            echo "OK"
-            SUCCESS=$((SUCCESS + 1))
-        else
-            echo "FAILED"
-            FAIL=$((FAIL + 1))
-        fi
-    else
-        # Local gcc build (Linux x86-64)
-        if gcc $BUILD_CFLAGS $EXTRA_FLAGS -o "$BINARIES_DIR/$OUTNAME" "$SRC" -lm 2>&1; then
-            echo "OK"
-            SUCCESS=$((SUCCESS + 1))
-        else
-            echo "FAILED"
-            FAIL=$((FAIL + 1))
-        fi
+    while [ "$(jobs -rp | wc -l)" -ge "$JOBS" ]; do
+        sleep 0.1
+    done
+    # Unquoted on purpose: collapses whitespace so the cache key is stable
+    build_one "$BASENAME" "$OUTNAME" "$(echo $BUILD_CFLAGS $EXTRA_FLAGS)" &
+done
+wait
+
+SUCCESS=0
+FAIL=0
+CACHED=0
+ENTRIES=()
+for STATUS_FILE in "$STATUS_DIR"/*; do
+    OUTNAME="$(basename "$STATUS_FILE")"
+    IFS=$'\t' read -r STATUS BASENAME FLAGS SRC_HASH KEY < "$STATUS_FILE"
+    if [ "$STATUS" = failed ]; then
+        FAIL=$((FAIL + 1))
+        continue
     fi
+    SUCCESS=$((SUCCESS + 1))
+    if [ "$STATUS" = cached ]; then
+        CACHED=$((CACHED + 1))
+    fi
+    ENTRIES+=("$(printf '    "%s": {"source": "samples/%s.c", "source_sha256": "%s", "flags": "%s", "cache_key": "%s", "sha256": "%s"}' \
+        "$OUTNAME" "$BASENAME" "$SRC_HASH" "$FLAGS" "$KEY" "$(sha256 "$BINARIES_DIR/$OUTNAME")")")
 done
 
+# Manifest checked by the harness (load_tasks) to catch stale binaries
+{
+    echo '{'
+    echo '  "format_version": 1,'
+    echo '  "target": "elf64-x86_64",'
+    printf '  "toolchain": "%s",\n' "$(echo "$TOOLCHAIN" | head -1 | sed 's/["\\]/\\&/g')"
+    echo '  "binaries": {'
+    for ((i = 0; i < ${#ENTRIES[@]}; i++)); do
+        if [ "$i" -lt $((${#ENTRIES[@]} - 1)) ]; then echo "${ENTRIES[$i]},"; else echo "${ENTRIES[$i]}"; fi
+    done
+    echo '  }'
+    echo '}'
+} > "$MANIFEST.tmp" && mv -f "$MANIFEST.tmp" "$MANIFEST"
+
 echo ""
-echo "=== Build complete: $SUCCESS succeeded, $FAIL failed ==="
+echo "=== Build complete: $SUCCESS succeeded ($CACHED cached), $FAIL failed ==="
 echo "Binaries in: $BINARIES_DIR"
 
+# Pre-analysis index (binaries/*.reidx). Optional: tools fall back to the
+# real readelf/objdump/nm when an index is missing or stale.
+if command -v python3 &>/dev/null; then
+    echo ""
+    python3 "$SCRIPT_DIR/build_index.py" "$BINARIES_DIR" \
+        || echo "Warning: index build failed; tools will run without it"
+fi
+
 if [ "$FAIL" -gt 0 ]; then
     exit 1
 fi
@@ -3,13 +3,22 @@
 # build_binaries_macho.sh — Compile all 13 C samples to MACH-O x86_64 binaries.
 #
 # Requires: macOS with native Clang/GCC toolchain
-# Output: binaries_macho/ directory with 13 MACH-O executables
+# Output: binaries_macho/ directory with 13 MACH-O executables, plus
+# binaries_macho/build_manifest.json
+#
+# Samples compile in parallel (-j N, default: CPU count) and share the
+# content-hash artifact cache in .cache/builds/ with build_binaries.sh;
+# --force ignores the cache.
+#
+# Usage: ./build_binaries_macho.sh [-j N] [--force]
 #
 set -euo pipefail
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 SAMPLES_DIR="$SCRIPT_DIR/samples"
 BINARIES_DIR="$SCRIPT_DIR/binaries_macho"
+CACHE_DIR="$SCRIPT_DIR/.cache/builds"
+MANIFEST="$BINARIES_DIR/build_manifest.json"
 
 # Common compilation flags for MACH-O
 # Note: macOS doesn't support -z execstack or -no-pie in the same way
@@ -18,7 +27,18 @@ BINARIES_DIR="$SCRIPT_DIR/binaries_macho"
 # -Wl,-no_pie: disable PIE (position independent executable)
 CFLAGS="-O0 -fno-stack-protector -arch x86_64"
 
-mkdir -p "$BINARIES_DIR"
+JOBS="$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4)"
+FORCE=false
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -j) JOBS="$2"; shift 2 ;;
+        -j*) JOBS="${1#-j}"; shift ;;
+        --force) FORCE=true; shift ;;
+        *) echo "Usage: $0 [-j N] [--force]"; exit 1 ;;
+    esac
+done
+
+mkdir -p "$BINARIES_DIR" "$CACHE_DIR"
 
 # Check for macOS and compiler
 if [[ "$(uname -s)" != "Darwin" ]]; then
@@ -42,9 +62,16 @@ fi
 echo "=== AgentRE-Bench: Building MACH-O x86_64 binaries ==="
 echo "Samples dir:  $SAMPLES_DIR"
 echo "Output dir:   $BINARIES_DIR"
-echo "Compiler:     $COMPILER ($($COMPILER --version | head -1))"
+echo "Compiler:     $COMPILER ($($COMPILER --version | head -1)), $JOBS jobs"
 echo ""
 
+sha256() {
+    shasum -a 256 "$@" | cut -d' ' -f1
+}
+
+# Identifies the toolchain for cache keys: compiler version and SDK
+TOOLCHAIN="$($COMPILER --version | head -1; xcrun --show-sdk-version 2>/dev/null || true)"
+
 # Function to map source filename to output binary name
 map_filename() {
     case "$1" in
@@ -65,50 +92,124 @@ map_filename() {
     esac
 }
 
-SUCCESS=0
-FAIL=0
+STATUS_DIR="$(mktemp -d)"
+trap 'rm -rf "$STATUS_DIR"' EXIT
+
+# Compile one sample into the artifact cache (unless already there) and copy
+# it to binaries_macho/. Runs in the background; the result goes to $STATUS_DIR.
+build_one() {
+    local BASENAME="$1" OUTNAME="$2" FLAGS="$3"
+    local SRC_HASH KEY ARTIFACT STATUS LOG=""
+    SRC_HASH="$(sha256 "$SAMPLES_DIR/$BASENAME.c")"
+    KEY="$(printf '%s\n' "macho-x86_64" "$TOOLCHAIN" "$FLAGS" "$SRC_HASH" | sha256)"
+    ARTIFACT="$CACHE_DIR/$KEY/$OUTNAME"
+
+    if [ "$FORCE" = false ] && [ -f "$ARTIFACT" ]; then
+        STATUS="cached"
+    else
+        mkdir -p "$CACHE_DIR/$KEY"
+        rm -f "$ARTIFACT.partial"
+        LOG="$($COMPILER $FLAGS -o "$ARTIFACT.partial" "$SAMPLES_DIR/$BASENAME.c" -lm 2>&1)" \
+            && STATUS="built" || STATUS="failed"
+        # Only complete artifacts enter the cache
+        if [ "$STATUS" = built ]; then
+            mv -f "$ARTIFACT.partial" "$ARTIFACT"
+        fi
+    fi
+    if [ -n "$LOG" ]; then
+        LOG+=$'\n'
+    fi
+
+    if [ "$STATUS" != failed ]; then
+        cp -p "$ARTIFACT" "$BINARIES_DIR/$OUTNAME.tmp" && mv -f "$BINARIES_DIR/$OUTNAME.tmp" "$BINARIES_DIR/$OUTNAME"
+    fi
+
+    case "$STATUS" in
+        cached) printf 'Building %s ... OK (cached)\n' "$OUTNAME" ;;
+        built)  printf 'Building %s ... OK\n%s' "$OUTNAME" "$LOG" ;;
+        *)      printf 'Building %s ... FAILED\n%s' "$OUTNAME" "$LOG" ;;
+    esac
+    printf '%s\t%s\t%s\t%s\t%s\n' "$STATUS" "$BASENAME" "$FLAGS" "$SRC_HASH" "$KEY" > "$STATUS_DIR/$OUTNAME"
+}
 
 for SRC in "$SAMPLES_DIR"/*.c; do
     # Extract base name without extension
     BASENAME="$(basename "$SRC" .c)"
     OUTNAME="$(map_filename "$BASENAME")"
 
-    echo -n "Building $OUTNAME ... "
-
     # Level 9 is a shared object (dylib on macOS)
     EXTRA_FLAGS=""
     BUILD_CFLAGS="$CFLAGS"
-    OUTPUT_PATH="$BINARIES_DIR/$OUTNAME"
 
     if [[ "$BASENAME" == *"level9"* ]]; then
         # macOS shared library flags
         EXTRA_FLAGS="-dynamiclib -undefined dynamic_lookup"
-        OUTPUT_PATH="$BINARIES_DIR/$OUTNAME.dylib"
+        OUTNAME="$OUTNAME.dylib"
     fi
 
-    if $COMPILER $BUILD_CFLAGS $EXTRA_FLAGS -o "$OUTPUT_PATH" "$SRC" -lm 2>&1; then
-        echo "OK"
-        SUCCESS=$((SUCCESS + 1))
-    else
-        echo "FAILED"
+    while [ "$(jobs -rp | wc -l)" -ge "$JOBS" ]; do
+        sleep 0.1
+    done
+    # Unquoted on purpose: collapses whitespace so the cache key is stable
+    build_one "$BASENAME" "$OUTNAME" "$(echo $BUILD_CFLAGS $EXTRA_FLAGS)" &
+done
+wait
+
+SUCCESS=0
+FAIL=0
+CACHED=0
+ENTRIES=()
+for STATUS_FILE in "$STATUS_DIR"/*; do
+    OUTNAME="$(basename "$STATUS_FILE")"
+    IFS=$'\t' read -r STATUS BASENAME FLAGS SRC_HASH KEY < "$STATUS_FILE"
+    if [ "$STATUS" = failed ]; then
         FAIL=$((FAIL + 1))
+        continue
+    fi
+    SUCCESS=$((SUCCESS + 1))
+    if [ "$STATUS" = cached ]; then
+        CACHED=$((CACHED + 1))
     fi
+    ENTRIES+=("$(printf '    "%s": {"source": "samples/%s.c", "source_sha256": "%s", "flags": "%s", "cache_key": "%s", "sha256": "%s"}' \
+        "$OUTNAME" "$BASENAME" "$SRC_HASH" "$FLAGS" "$KEY" "$(sha256 "$BINARIES_DIR/$OUTNAME")")")
 done
 
+{
+    echo '{'
+    echo '  "format_version": 1,'
+    echo '  "target": "macho-x86_64",'
+    printf '  "toolchain": "%s",\n' "$(echo "$TOOLCHAIN" | head -1 | sed 's/["\\]/\\&/g')"
+    echo '  "binaries": {'
+    for ((i = 0; i < ${#ENTRIES[@]}; i++)); do
+        if [ "$i" -lt $((${#ENTRIES[@]} - 1)) ]; then echo "${ENTRIES[$i]},"; else echo "${ENTRIES[$i]}"; fi
+    done
+    echo '  }'
+    echo '}'
+} > "$MANIFEST.tmp" && mv -f "$MANIFEST.tmp" "$MANIFEST"
+
 echo ""
-echo "=== Build complete: $SUCCESS succeeded, $FAIL failed ==="
+echo "=== Build complete: $SUCCESS succeeded ($CACHED cached), $FAIL failed ==="
 echo "Binaries in: $BINARIES_DIR"
 
 # Verify MACH-O format
 echo ""
 echo "=== Verifying MACH-O format ==="
 for BIN in "$BINARIES_DIR"/*; do
+    case "$BIN" in *.json|*.reidx) continue ;; esac
     if [ -f "$BIN" ]; then
         FILETYPE=$(file "$BIN" | cut -d: -f2)
         echo "$(basename "$BIN"): $FILETYPE"
     fi
 done
 
+# Pre-analysis index (binaries_macho/*.reidx), captured with the tools image
+# the benchmark runs in. Optional: tools fall back to the real binaries.
+if command -v python3 &>/dev/null; then
+    echo ""
+    python3 "$SCRIPT_DIR/build_index.py" "$BINARIES_DIR" \
+        || echo "Warning: index build failed; tools will run without it"
+fi
+
 if [ "$FAIL" -gt 0 ]; then
     exit 1
 fi
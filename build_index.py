@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+Pre-compute tool output for benchmark binaries into <binary>.reidx files.
+
+The index holds the exact output of the common readelf / objdump / nm /
+strings / file / entropy invocations (including section-scoped `-j` ones) and
+a per-function table into the `objdump -d` output. ToolExecutor serves those
+calls from the index instead of spawning a process, and falls back to the
+real tool when the index is missing, or was built for a different binary or
+tool environment.
+
+Usage:
+    python build_index.py                       # all of binaries/, tools image if available
+    python build_index.py --no-docker           # index for --no-docker runs
+    python build_index.py binaries_macho/ -j 4
+    python build_index.py --force               # rebuild even up-to-date indexes
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+from harness.config import BenchmarkConfig
+from harness.index import INDEX_SUFFIX, BinaryIndex, command_key, tool_environment, write_index
+from harness.tools import ToolExecutor
+
+PROJECT_ROOT = Path(__file__).resolve().parent
+
+# Entries larger than this are left to the real tool (which stops at the
+# output limit anyway) rather than bloating the index.
+MAX_ENTRY_BYTES = 16 * 1024 * 1024
+
+_SECTION_RE = re.compile(r"^\s*\d+\s+(\S+)\s+[0-9a-f]{8,}", re.MULTILINE)
+
+
+def tool_inputs(sections: list[str]) -> list[tuple[str, dict]]:
+    inputs: list[tuple[str, dict]] = [("file", {}), ("strings", {}), ("nm", {})]
+    inputs += [("readelf", {"flags": f}) for f in ("-h", "-S", "-s", "-l", "-d", "-a")]
+    inputs += [("objdump", {"flags": f}) for f in ("-d", "-t", "-x")]
+    for section in sections:
+        inputs += [("objdump", {"flags": f, "section": section}) for f in ("-d", "-s")]
+        inputs.append(("entropy", {"section": section}))
+    inputs += [("entropy", {}), ("entropy", {"per_section": True})]
+    return inputs
+
+
+def index_binary(config: BenchmarkConfig, binary: Path, environment: str) -> str:
+    executor = ToolExecutor(config, binary)
+    try:
+        name = binary.name
+        sandbox_path = executor._resolve_path(name)
+
+        headers = executor.runner.run(["objdump", "-h", sandbox_path])
+        sections = _SECTION_RE.findall(headers.stdout) if headers.returncode == 0 else []
+
+        outputs = {}
+        for tool, args in tool_inputs(sections):
+            try:
+                cmd = executor._build_command(tool, {"path": name, **args})
+            except (ValueError, FileNotFoundError):
+                continue  # e.g. entropy per_section without the native helper
+            result = executor.runner.run(cmd)
+            # Only real tool output; the rest is left to the live fallback
+            if result.timed_out or result.truncated or result.sandbox_failed:
+                continue
+            outputs[command_key(executor._normalize_command(cmd, sandbox_path))] = (result, sandbox_path)
+
+        path = write_index(binary, environment, outputs)
+        return f"{name}: {len(outputs)} entries, {path.stat().st_size // 1024} KB"
+    finally:
+        executor.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build per-binary pre-analysis indexes")
+    parser.add_argument("paths", nargs="*", help="Binaries or directories (default: binaries/)")
+    parser.add_argument("--no-docker", action="store_true", help="Capture with local tools instead of the tools image")
+    parser.add_argument("--image", default="agentre-bench-tools:latest", help="Tools Docker image")
+    parser.add_argument("-j", "--jobs", type=int, default=4, help="Binaries indexed concurrently (default: 4)")
+    parser.add_argument("--force", action="store_true", help="Rebuild indexes that are already up to date")
+    args = parser.parse_args()
+
+    def is_binary(f: Path) -> bool:
+        return f.is_file() and f.suffix not in (INDEX_SUFFIX, ".tmp", ".json")
+
+    binaries: list[Path] = []
+    for p in [Path(x) for x in args.paths] or [PROJECT_ROOT / "binaries"]:
+        if p.is_dir():
+            binaries += sorted(f for f in p.iterdir() if is_binary(f))
+        elif is_binary(p):
+            binaries.append(p)
+    if not binaries:
+        print("No binaries found; build them first.")
+        sys.exit(1)
+
+    use_docker = not args.no_docker
+    if use_docker:
+        probe = subprocess.run(["docker", "image", "inspect", args.image], capture_output=True) \
+            if _has_docker() else None
+        if probe is None or probe.returncode != 0:
+            print(f"Tools image {args.image} not available; indexing with local tools (--no-docker runs only)")
+            use_docker = False
+
+    environment = tool_environment(use_docker, args.image)
+    print(f"=== Indexing {len(binaries)} binaries ({environment}) ===")
+
+    # The workspace is each binary's own directory, exactly as at run time
+    ok = failed = fresh = 0
+    with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        futures = []
+        for binary in binaries:
+            if not args.force:
+                existing = BinaryIndex.open(binary.resolve(), environment)
+                if existing is not None:
+                    existing.close()
+                    fresh += 1
+                    continue
+            config = BenchmarkConfig(
+                project_root=PROJECT_ROOT,
+                workspace_dir=binary.resolve().parent,
+                ground_truths_dir=PROJECT_ROOT / "ground_truths",
+                docker_image=args.image,
+                use_docker=use_docker,
+                pooled_sandbox=True,
+                tool_cache_enabled=False,
+                binary_index_enabled=False,
+                max_output_chars=MAX_ENTRY_BYTES,
+                tool_timeout_seconds=120,
+            )
+            futures.append((binary, pool.submit(index_binary, config, binary.resolve(), environment)))
+        for binary, future in futures:
+            try:
+                print("  " + future.result())
+                ok += 1
+            except Exception as e:
+                print(f"  {binary.name}: FAILED ({e})")
+                failed += 1
+
+    print(f"=== Index complete: {ok} built, {fresh} up to date, {failed} failed ===")
+    if failed:
+        sys.exit(1)
+
+
+def _has_docker() -> bool:
+    try:
+        subprocess.run(["docker", "version"], capture_output=True, timeout=10)
+        return True
+    except (OSError, subprocess.TimeoutExpired):
+        return False
+
+
+if __name__ == "__main__":
+    main()
@@ -2,6 +2,11 @@
 """
 Generate interactive HTML visualizations from AgentRE-Bench results.
 
+Reports are ingested into a SQLite store (<first results dir>/results.sqlite)
+and only new or rewritten reports are read on the next run. The HTML embeds
+per-run summaries; each run's task details are written next to it in
+<output>_data/ and loaded when that run is opened.
+
 Usage:
     python generate_visualizations.py results_cs_comparison/ -o visualizations.html
     python generate_visualizations.py results/ results_cs_comparison/ --max-models 8
@@ -9,11 +14,16 @@ Usage:
 """
 
 import argparse
+import hashlib
 import json
+import re
 from pathlib import Path
 from datetime import datetime
 from typing import List, Dict, Any
 
+from harness.results_store import STORE_FILENAME, ResultsStore
+from harness.transcript import find_transcript, tool_sequence
+
 
 def scan_results_directory(root: Path) -> List[Path]:
     """Find all benchmark_report.json files recursively."""
@@ -72,15 +82,76 @@ def load_benchmark_report(path: Path) -> Dict[str, Any]:
     with open(path) as f:
         data = json.load(f)
 
-    # Add label extracted from directory name
+    # Add label extracted from directory name; --trials keeps trial N in <run>/trial_N/
     dir_name = path.parent.name
-    data['label'] = extract_model_label(dir_name)
+    trial = re.fullmatch(r"trial_(\d+)", dir_name)
+    if trial:
+        data['label'] = f"{extract_model_label(path.parent.parent.name)} (trial {trial.group(1)})"
+    else:
+        data['label'] = extract_model_label(dir_name)
+
+    attach_tool_sequences(data, path.parent / "transcripts")
 
     return data
 
 
+def attach_tool_sequences(report: Dict[str, Any], transcripts_dir: Path) -> None:
+    """Add each task's tool-call sequence (tool names) from its transcript, if present."""
+    if not transcripts_dir.is_dir():
+        return
+    for task in report.get('task_metrics', []):
+        path = find_transcript(transcripts_dir, task.get('task_id', ''))
+        if path is not None:
+            task['tool_sequence'] = [call['tool'] for call in tool_sequence(path)]
+
+
+def ingest_reports(store: ResultsStore, report_paths: List[Path]) -> List[str]:
+    """Ingest new or changed reports; returns the run_id of every report."""
+    run_ids = []
+    for path in report_paths:
+        try:
+            if store.is_current(path):
+                print(f"  = {path.parent.name}")
+            else:
+                report = load_benchmark_report(path)
+                store.ingest(path, report, report['label'])
+                print(f"  + {report['label']}")
+            run_ids.append(str(path.resolve().parent))
+        except Exception as e:
+            print(f"  ✗ Failed to load {path}: {e}")
+    return run_ids
+
+
+def write_detail_slices(store: ResultsStore, runs: List[Dict[str, Any]], data_dir: Path) -> int:
+    """
+    Write one <script>-loadable file of task details per run into data_dir.
+
+    Files are named by run and report revision, so an unchanged run keeps
+    its file and a rewritten one gets a new name. Sets each run's 'detail'
+    to the file path relative to the HTML. Returns how many were written.
+    """
+    data_dir.mkdir(parents=True, exist_ok=True)
+    written = 0
+    referenced = set()
+    for run in runs:
+        digest = hashlib.sha256(f"{run['run_id']}:{run['revision']}".encode()).hexdigest()[:16]
+        name = f"run_{digest}.js"
+        referenced.add(name)
+        run['detail'] = f"{data_dir.name}/{name}"
+        path = data_dir / name
+        if path.exists():
+            continue
+        detail = json.dumps(store.run_detail(run['run_id']))
+        path.write_text(f"agentreBenchDetail({json.dumps(run['run_id'])}, {detail});\n")
+        written += 1
+    for old in data_dir.glob("run_*.js"):
+        if old.name not in referenced:
+            old.unlink()
+    return written
+
+
 def generate_html(reports: List[Dict[str, Any]], css_path: Path, js_path: Path) -> str:
-    """Generate self-contained HTML with embedded data, CSS, and JavaScript."""
+    """Generate HTML with embedded run summaries, CSS, and JavaScript."""
 
     # Read CSS and JS files
     css_content = css_path.read_text()
@@ -187,6 +258,16 @@ Examples:
         default=Path(__file__).parent / 'visualizations.js',
         help='Path to JavaScript file (default: visualizations.js in script directory)'
     )
+    parser.add_argument(
+        '--store',
+        type=Path,
+        help=f'Results store (default: <first_results_dir>/{STORE_FILENAME})'
+    )
+    parser.add_argument(
+        '--self-contained',
+        action='store_true',
+        help='Embed every run\'s task details in the HTML instead of loading them on demand'
+    )
 
     args = parser.parse_args()
 
@@ -216,19 +297,17 @@ Examples:
         print("Error: No benchmark_report.json files found")
         return 1
 
-    # Load reports
-    print(f"\nLoading {len(all_report_paths)} benchmark reports...")
-    reports = []
-    for path in all_report_paths:
-        try:
-            report = load_benchmark_report(path)
-            reports.append(report)
-            print(f"  ✓ {report['label']}")
-        except Exception as e:
-            print(f"  ✗ Failed to load {path}: {e}")
+    # Ingest new or changed reports (= unchanged, + ingested)
+    store_path = args.store or args.results_dirs[0] / STORE_FILENAME
+    print(f"\nIngesting {len(all_report_paths)} benchmark reports into {store_path}...")
+    store = ResultsStore(store_path)
+    run_ids = ingest_reports(store, all_report_paths)
+    store.prune()
+    reports = store.run_summaries(run_ids)
 
     if not reports:
         print("Error: Failed to load any benchmark reports")
+        store.close()
         return 1
 
     # Sort by timestamp (newest first) if multiple reports
@@ -246,6 +325,16 @@ Examples:
     else:
         output_path = args.results_dirs[0] / 'visualizations.html'
 
+    # Task details: inline, or one lazily loaded file per run
+    if args.self_contained:
+        for report in reports:
+            report['detail'] = store.run_detail(report['run_id'])
+    else:
+        data_dir = output_path.with_name(output_path.stem + '_data')
+        written = write_detail_slices(store, reports, data_dir)
+        print(f"\nTask details: {data_dir} ({written} written, {len(reports) - written} unchanged)")
+    store.close()
+
     # Generate HTML
     print(f"\nGenerating HTML with {len(reports)} models...")
     html_content = generate_html(reports, args.css, args.js)
@@ -3,14 +3,34 @@ from __future__ import annotations
 import json
 import logging
 import time
-from typing import Any
+from concurrent.futures import Future, ThreadPoolExecutor
+from typing import Any, Callable
 
 from .langfuse import NoopLangfuseClient
-from .providers.base import AgentProvider, ProviderResponse
+from .providers.base import AgentProvider, ProviderResponse, ToolCall
+from .timing import PhaseTimer, TimedProxy, merge_samples
 from .tools import ToolExecutor, get_tool_schemas_for_format
 
 log = logging.getLogger(__name__)
 
+# Loop state saved in each transcript checkpoint and restored on --resume
+CHECKPOINT_FIELDS = (
+    "tool_call_count",
+    "tool_calls_log",
+    "input_tokens",
+    "output_tokens",
+    "cache_read_tokens",
+    "cache_write_tokens",
+    "invalid_tool_calls",
+    "invalid_json_attempts",
+    "step_timings",
+)
+
+# Prompt tokens kept free, when fitting tool results, for the messages after them
+CONTEXT_RESERVE_TOKENS = 1024
+# Smallest page a held tool result is served in
+MIN_HELD_PAGE_CHARS = 400
+
 
 class AgentLoop:
     def __init__(
@@ -22,10 +42,19 @@ class AgentLoop:
         file_type: str = "ELF64",
         max_tool_calls: int = 25,
         max_tokens: int = 4096,
+        token_budget: int = 0,
+        context_tokens: int = 0,
         verbose: bool = False,
         langfuse: Any = None,
         langfuse_trace_id: str | None = None,
+        progress_callback: Callable[[], None] | None = None,
+        streaming: bool = False,
+        tool_parallelism: int = 1,
+        transcript: Any = None,
+        resume_state: dict | None = None,
     ):
+        # llm / tool / tool_wait here; Langfuse and transcript calls are timed through proxies
+        self.timer = PhaseTimer()
         self.provider = provider
         self.tool_executor = tool_executor
         self.system_prompt = system_prompt
@@ -33,17 +62,39 @@ class AgentLoop:
         self.file_type = file_type
         self.max_tool_calls = max_tool_calls
         self.max_tokens = max_tokens
+        self.token_budget = token_budget
+        # Tool results are fitted to this many prompt tokens before being sent; 0 = not fitted
+        self.context_limit = (context_tokens or provider.context_window) if token_budget or context_tokens else 0
         self.verbose = verbose
         self.langfuse = langfuse or NoopLangfuseClient()
+        if self.langfuse.enabled:
+            self.langfuse = TimedProxy(self.langfuse, self.timer, "langfuse")
         self.langfuse_trace_id = langfuse_trace_id
+        self.progress_callback = progress_callback
+        self.streaming = streaming and provider.supports_streaming
+        self.tool_parallelism = max(1, tool_parallelism)
+        self.transcript = TimedProxy(transcript, self.timer, "transcript") if transcript is not None else None
+        self.resume_state = resume_state
+        self.resumed_steps = 0
+        self.prior_wall_time = 0.0
 
         self.messages: list[dict] = []
         self.tool_call_count = 0
         self.tool_calls_log: list[dict] = []
         self.input_tokens = 0
         self.output_tokens = 0
+        self.cache_read_tokens = 0
+        self.cache_write_tokens = 0
         self.invalid_tool_calls = 0
         self.invalid_json_attempts = 0
+        self.http_connect_seconds = 0.0
+        self.http_new_connections = 0
+        self.http_reused_connections = 0
+        self.step_timings: list[dict] = []
+        self.context_estimate = 0      # prompt tokens the next request will take (when fitting)
+        self.max_prompt_tokens = 0
+        self.token_budget_hit = False
+        self.token_warning_sent = False
 
         # Error tracking
         self.error_occurred = False
@@ -58,27 +109,219 @@ class AgentLoop:
 
     def _dot(self):
         """Print a progress dot in non-verbose mode."""
-        if not self.verbose:
+        if self.progress_callback is not None:
+            self.progress_callback()
+        elif not self.verbose:
             print(".", end="", flush=True)
 
+    def _estimate(self, value: Any) -> int:
+        return self.provider.estimate_tokens(value if isinstance(value, str) else json.dumps(value, default=str))
+
+    def _add_message(self, message: dict) -> None:
+        self.messages.append(message)
+        if self.context_limit:
+            self.context_estimate += self._estimate(message)
+        if self.transcript is not None:
+            self.transcript.message(len(self.messages) - 1, message)
+
+    def _checkpoint(self, start_time: float) -> None:
+        """Record loop state at a step boundary so --resume can continue from here."""
+        if self.transcript is None:
+            return
+        self.transcript.write(
+            "checkpoint",
+            messages=len(self.messages),
+            wall_time_seconds=round(self.prior_wall_time + time.time() - start_time, 2),
+            **{name: getattr(self, name) for name in CHECKPOINT_FIELDS},
+            **({"pager_next_id": pager.next_id} if (pager := self.tool_executor.pager) else {}),
+        )
+
+    def _restore(self, state: dict) -> None:
+        """Continue from the last checkpoint of an interrupted transcript."""
+        checkpoint = state["checkpoint"]
+        for message in state["messages"][:checkpoint["messages"]]:
+            self._add_message(message)
+        for name in CHECKPOINT_FIELDS:
+            if name in checkpoint:
+                setattr(self, name, checkpoint[name])
+        # Held outputs are not restored; their cursors in the replayed messages
+        # must not name the new outputs, which are numbered past them
+        if self.tool_executor.pager is not None:
+            self.tool_executor.pager.skip_to(checkpoint.get("pager_next_id", 1))
+        self.prior_wall_time = checkpoint.get("wall_time_seconds", 0.0)
+        self.resumed_steps = len(self.step_timings)
+        # Carry the finished turns' step records over, so the new transcript replays whole
+        if self.transcript is not None:
+            for step in state["steps"]:
+                if step.get("step", 0) <= self.resumed_steps:
+                    self.transcript.write("step", **step)
+        self._vprint(f"\n  Resuming at step {self.resumed_steps + 1} ({self.tool_call_count} tool calls done)")
+
+    def _call_provider(self, tools: list[dict], pool: ThreadPoolExecutor | None):
+        """One model turn. Returns (response, dispatched, timing).
+
+        With a pool, tool calls are submitted as soon as they are known: in
+        streaming mode the moment the provider reports each one complete (so
+        the sandbox works while the model is still decoding), otherwise all at
+        once when the response arrives. `dispatched` holds
+        (tool_call, ready_at, future) in issue order; nothing after a
+        final_answer is dispatched.
+        """
+        dispatched: list[tuple[ToolCall, float, Future]] = []
+        sent = time.monotonic()
+        throttled = getattr(self.provider, "throttle_seconds", 0.0)
+
+        def dispatch(tc: ToolCall) -> None:
+            if any(d[0].name == "final_answer" for d in dispatched):
+                return
+            ready = time.monotonic()
+            dispatched.append((tc, ready, pool.submit(self._timed_execute, tc)))
+
+        if self.streaming:
+            response = self.provider.stream_message(
+                system=self.system_prompt,
+                messages=self.messages,
+                tools=tools,
+                max_tokens=self.max_tokens,
+                on_tool_call=dispatch,
+            )
+        else:
+            response = self.provider.create_message(
+                system=self.system_prompt,
+                messages=self.messages,
+                tools=tools,
+                max_tokens=self.max_tokens,
+            )
+            if pool is not None and response.stop_reason == "tool_use":
+                for tc in response.tool_calls or []:
+                    dispatch(tc)
+
+        # Limiter waits and retry backoff are reported as "throttle", not as LLM time
+        sent += getattr(self.provider, "throttle_seconds", 0.0) - throttled
+        llm_seconds = time.monotonic() - sent
+        self.timer.add("llm", llm_seconds)
+        timing = {
+            "llm_seconds": round(llm_seconds, 3),
+            "ttft_seconds": round(response.ttft_seconds, 3),
+            "generation_seconds": round(response.generation_seconds, 3),
+            "first_tool_call_seconds": (
+                round(dispatched[0][1] - sent, 3) if dispatched
+                else round(llm_seconds, 3) if response.tool_calls else None
+            ),
+            "tool_dispatch_latency": [],
+        }
+        return response, dispatched, timing
+
+    def _timed_execute(self, tc: ToolCall) -> tuple[dict, float]:
+        started = time.monotonic()
+        with self.timer.phase("tool"):
+            return self.tool_executor.execute(tc.name, tc.input), started
+
     def run(self) -> dict[str, Any]:
         start_time = time.time()
-        tools = get_tool_schemas_for_format(self.file_type, include_final_answer=True)
-
-        # Initial user message
-        self.messages.append({
-            "role": "user",
-            "content": (
-                "Analyze the binary file in the workspace and submit your findings "
-                "using the final_answer tool. The binary is located at the path "
-                "shown in the system prompt. Use the available RE tools to examine it."
-            ),
-        })
+        tools = get_tool_schemas_for_format(
+            self.file_type,
+            include_final_answer=True,
+            include_paging=getattr(self.tool_executor, "pager", None) is not None,
+        )
+
+        if self.context_limit:
+            self.context_estimate = self._estimate(self.system_prompt) + self._estimate(tools)
+        if self.resume_state is not None:
+            self._restore(self.resume_state)
+        else:
+            # Initial user message
+            self._add_message({
+                "role": "user",
+                "content": (
+                    "Analyze the binary file in the workspace and submit your findings "
+                    "using the final_answer tool. The binary is located at the path "
+                    "shown in the system prompt. Use the available RE tools to examine it."
+                ),
+            })
+
+        # Tool calls run on a per-task pool when streaming or running them in
+        # parallel; results are still consumed in the order the model issued them.
+        pool = None
+        if self.streaming or self.tool_parallelism > 1:
+            pool = ThreadPoolExecutor(
+                max_workers=self.tool_parallelism,
+                thread_name_prefix=f"tools-{self.task_id}",
+            )
+        try:
+            final_answer, max_steps_hit = self._loop(tools, pool, start_time)
+        finally:
+            if pool is not None:
+                pool.shutdown(wait=True, cancel_futures=True)
+
+        wall_time = self.prior_wall_time + time.time() - start_time
+
+        self._vprint(
+            f"\n  Done: {self.tool_call_count} calls, "
+            f"{wall_time:.1f}s, "
+            f"{self.input_tokens + self.output_tokens:,} tokens"
+        )
+
+        # Compute tool usage stats
+        tool_calls_by_type: dict[str, int] = {}
+        seen_calls: set[str] = set()
+        redundant_tool_calls = 0
+        for entry in self.tool_calls_log:
+            name = entry["tool"]
+            tool_calls_by_type[name] = tool_calls_by_type.get(name, 0) + 1
+            call_key = f"{name}:{json.dumps(entry['input'], sort_keys=True, default=str)}"
+            if call_key in seen_calls:
+                redundant_tool_calls += 1
+            seen_calls.add(call_key)
+
+        provider_timer = getattr(self.provider, "timer", None)
+        return {
+            "task_id": self.task_id,
+            "final_answer": final_answer,
+            "transcript": self.messages,
+            "tool_call_count": self.tool_call_count,
+            "tool_calls_by_type": tool_calls_by_type,
+            "tool_calls_log": self.tool_calls_log,
+            "redundant_tool_calls": redundant_tool_calls,
+            "invalid_tool_calls": self.invalid_tool_calls,
+            "invalid_json_attempts": self.invalid_json_attempts,
+            "input_tokens": self.input_tokens,
+            "output_tokens": self.output_tokens,
+            "total_tokens": self.input_tokens + self.output_tokens,
+            "cache_read_tokens": self.cache_read_tokens,
+            "cache_write_tokens": self.cache_write_tokens,
+            "wall_time_seconds": round(wall_time, 2),
+            "step_timings": self.step_timings,
+            "phase_samples": merge_samples(self.timer.snapshot(), provider_timer.snapshot() if provider_timer else {}),
+            "http_stats": {
+                "connect_seconds": round(self.http_connect_seconds, 3),
+                "new_connections": self.http_new_connections,
+                "reused_connections": self.http_reused_connections,
+                "throttle_seconds": round(getattr(self.provider, "throttle_seconds", 0.0), 3),
+                "retries": getattr(self.provider, "retries", 0),
+            },
+            "max_steps_hit": max_steps_hit,
+            "token_budget": self.token_budget,
+            "token_budget_hit": self.token_budget_hit,
+            "max_prompt_tokens": self.max_prompt_tokens,
+            "has_valid_answer": final_answer is not None,
+            "resumed_steps": self.resumed_steps,
+            "error_info": {
+                "error_occurred": self.error_occurred,
+                "error_type": self.error_type,
+                "error_message": self.error_message,
+                "http_status_code": self.http_status_code,
+            },
+        }
 
+    def _loop(self, tools: list[dict], pool: ThreadPoolExecutor | None, start_time: float) -> tuple[dict | None, bool]:
         final_answer = None
         max_steps_hit = False
 
         while self.tool_call_count < self.max_tool_calls:
+            self._checkpoint(start_time)
+            if self._over_token_budget():
+                break
             generation_id = self.langfuse.create_generation(
                 trace_id=self.langfuse_trace_id,
                 name="llm.create_message",
@@ -92,12 +335,7 @@ class AgentLoop:
                 metadata={"task_id": self.task_id, "tool_call_count": self.tool_call_count},
             )
             try:
-                response = self.provider.create_message(
-                    system=self.system_prompt,
-                    messages=self.messages,
-                    tools=tools,
-                    max_tokens=self.max_tokens,
-                )
+                response, dispatched, timing = self._call_provider(tools, pool)
             except Exception as e:
                 # Classify the error
                 error_str = str(e)
@@ -170,11 +408,39 @@ class AgentLoop:
                     "task_id": self.task_id,
                     "stop_reason": response.stop_reason,
                     "tool_calls": len(response.tool_calls or []),
+                    "cache_read_tokens": response.cache_read_tokens,
+                    "cache_write_tokens": response.cache_write_tokens,
+                    "ttft_seconds": timing["ttft_seconds"],
+                    "generation_seconds": timing["generation_seconds"],
                 },
             )
+            self.step_timings.append(timing)
+            if self.transcript is not None:
+                # `messages` so far: the turn's assistant message, if it adds one, is next
+                self.transcript.write(
+                    "step",
+                    step=len(self.step_timings),
+                    messages=len(self.messages),
+                    stop_reason=response.stop_reason,
+                    input_tokens=response.input_tokens,
+                    output_tokens=response.output_tokens,
+                    **timing,
+                )
+            response_done = time.monotonic()
 
             self.input_tokens += response.input_tokens
             self.output_tokens += response.output_tokens
+            self.max_prompt_tokens = max(self.max_prompt_tokens, response.input_tokens)
+            if self.context_limit and response.input_tokens:
+                # Re-anchor on the real prompt size; later messages are added as estimates
+                self.context_estimate = response.input_tokens
+            self.cache_read_tokens += response.cache_read_tokens
+            self.cache_write_tokens += response.cache_write_tokens
+            self.http_connect_seconds += response.connect_seconds
+            if response.connection_reused:
+                self.http_reused_connections += 1
+            else:
+                self.http_new_connections += 1
 
             if response.stop_reason == "tool_use" and response.tool_calls:
                 # Show agent reasoning (verbose only)
@@ -202,11 +468,11 @@ class AgentLoop:
                         block["metadata"] = tc.metadata
                     assistant_content.append(block)
 
-                self.messages.append({"role": "assistant", "content": assistant_content})
+                self._add_message({"role": "assistant", "content": assistant_content})
 
-                # Execute each tool call
+                # Execute each tool call (dispatched calls are already running)
                 tool_results = []
-                for tc in response.tool_calls:
+                for i, tc in enumerate(response.tool_calls):
                     self.tool_call_count += 1
                     self.tool_calls_log.append({
                         "call_number": self.tool_call_count,
@@ -233,7 +499,14 @@ class AgentLoop:
                             "tool": tc.name,
                         },
                     )
-                    result = self.tool_executor.execute(tc.name, tc.input)
+                    if i < len(dispatched) and dispatched[i][0].id == tc.id:
+                        _, ready, future = dispatched[i]
+                        with self.timer.phase("tool_wait"):
+                            result, started = future.result()
+                    else:
+                        ready = response_done
+                        result, started = self._timed_execute(tc)
+                    timing["tool_dispatch_latency"].append(round(max(0.0, started - ready), 3))
 
                     if result.get("is_final_answer"):
                         final_answer = result["answer"]
@@ -261,6 +534,8 @@ class AgentLoop:
                         output_text = result.get("output", "(no output)")
 
                     self.tool_calls_log[-1]["output_preview"] = output_text[:500]
+                    if result.get("truncated"):
+                        self.tool_calls_log[-1]["output_bytes"] = result.get("output_bytes", 0)
 
                     self.langfuse.end_span(
                         trace_id=self.langfuse_trace_id,
@@ -300,12 +575,14 @@ class AgentLoop:
                     break
 
                 if tool_results:
-                    self.messages.append({"role": "user", "content": tool_results})
+                    if self.context_limit:
+                        self._fit_tool_results(tool_results)
+                    self._add_message({"role": "user", "content": tool_results})
 
                     # Budget warnings
                     remaining = self.max_tool_calls - self.tool_call_count
                     if remaining == 5:
-                        self.messages.append({
+                        self._add_message({
                             "role": "user",
                             "content": (
                                 "IMPORTANT: You have only 5 tool calls remaining. "
@@ -317,7 +594,7 @@ class AgentLoop:
                         })
                         self._vprint(f"\n  ** Budget warning: 5 calls left **")
                     elif remaining == 2:
-                        self.messages.append({
+                        self._add_message({
                             "role": "user",
                             "content": (
                                 "CRITICAL: You have only 2 tool calls left. "
@@ -327,6 +604,20 @@ class AgentLoop:
                         })
                         self._vprint(f"\n  ** Budget warning: 2 calls left **")
 
+                    if self.token_budget and not self.token_warning_sent:
+                        left = self.token_budget - self.input_tokens - self.output_tokens
+                        if left < 2 * (self.context_estimate + self.max_tokens):
+                            self.token_warning_sent = True
+                            self._add_message({
+                                "role": "user",
+                                "content": (
+                                    "CRITICAL: Your token budget is nearly spent; there is room "
+                                    "for about one more turn. Call the final_answer tool NOW "
+                                    "with your best analysis."
+                                ),
+                            })
+                            self._vprint(f"\n  ** Budget warning: {left:,} tokens left **")
+
             elif response.stop_reason == "end_turn":
                 if response.text_content:
                     self._vprint(f"\n  Agent (no tool call):")
@@ -343,11 +634,11 @@ class AgentLoop:
                 # Prompt agent to use final_answer tool
                 self.invalid_json_attempts += 1
                 self._vprint(f"  (nudging agent to use final_answer tool)")
-                self.messages.append({
+                self._add_message({
                     "role": "assistant",
                     "content": response.text_content,
                 })
-                self.messages.append({
+                self._add_message({
                     "role": "user",
                     "content": (
                         "Please submit your analysis using the final_answer tool. "
@@ -359,11 +650,11 @@ class AgentLoop:
             elif response.stop_reason == "max_tokens":
                 self._vprint(f"\n  !! Hit max_tokens — continuing")
                 if response.text_content:
-                    self.messages.append({
+                    self._add_message({
                         "role": "assistant",
                         "content": response.text_content,
                     })
-                    self.messages.append({
+                    self._add_message({
                         "role": "user",
                         "content": "Please continue your analysis and submit via final_answer tool.",
                     })
@@ -381,49 +672,50 @@ class AgentLoop:
             )
             self._vprint(f"\n  !! Hit max tool calls limit ({self.max_tool_calls})")
 
-        wall_time = time.time() - start_time
 
-        self._vprint(
-            f"\n  Done: {self.tool_call_count} calls, "
-            f"{wall_time:.1f}s, "
-            f"{self.input_tokens + self.output_tokens:,} tokens"
+        return final_answer, max_steps_hit
+
+    def _over_token_budget(self) -> bool:
+        """True once the next request could take the task past its token budget."""
+        if not self.token_budget:
+            return False
+        spent = self.input_tokens + self.output_tokens
+        if spent + self.context_estimate + self.max_tokens <= self.token_budget:
+            return False
+        self.token_budget_hit = True
+        self.langfuse.create_event(
+            trace_id=self.langfuse_trace_id,
+            name="token_budget_hit",
+            metadata={"task_id": self.task_id, "token_budget": self.token_budget, "tokens_used": spent},
+            level="WARNING",
         )
-
-        # Compute tool usage stats
-        tool_calls_by_type: dict[str, int] = {}
-        seen_calls: set[str] = set()
-        redundant_tool_calls = 0
-        for entry in self.tool_calls_log:
-            name = entry["tool"]
-            tool_calls_by_type[name] = tool_calls_by_type.get(name, 0) + 1
-            call_key = f"{name}:{json.dumps(entry['input'], sort_keys=True, default=str)}"
-            if call_key in seen_calls:
-                redundant_tool_calls += 1
-            seen_calls.add(call_key)
-
-        return {
-            "task_id": self.task_id,
-            "final_answer": final_answer,
-            "transcript": self.messages,
-            "tool_call_count": self.tool_call_count,
-            "tool_calls_by_type": tool_calls_by_type,
-            "tool_calls_log": self.tool_calls_log,
-            "redundant_tool_calls": redundant_tool_calls,
-            "invalid_tool_calls": self.invalid_tool_calls,
-            "invalid_json_attempts": self.invalid_json_attempts,
-            "input_tokens": self.input_tokens,
-            "output_tokens": self.output_tokens,
-            "total_tokens": self.input_tokens + self.output_tokens,
-            "wall_time_seconds": round(wall_time, 2),
-            "max_steps_hit": max_steps_hit,
-            "has_valid_answer": final_answer is not None,
-            "error_info": {
-                "error_occurred": self.error_occurred,
-                "error_type": self.error_type,
-                "error_message": self.error_message,
-                "http_status_code": self.http_status_code,
-            },
-        }
+        self._vprint(f"\n  !! Token budget reached ({spent:,} of {self.token_budget:,} used)")
+        return True
+
+    def _fit_tool_results(self, results: list[dict]) -> None:
+        """Cut one turn's tool results down to the room left in the prompt.
+
+        The room is what the context limit (and the token budget, if any)
+        leaves after the prompt so far, one max_tokens response and a small
+        reserve. Results get an equal share of it, smallest first, so short
+        ones pass untouched and the spare goes to the long ones. A result over
+        its share is held by the tool executor and read back by paging.
+        """
+        room = self.context_limit - self.context_estimate - self.max_tokens - CONTEXT_RESERVE_TOKENS
+        if self.token_budget:
+            spent = self.input_tokens + self.output_tokens
+            room = min(room, self.token_budget - spent - self.context_estimate - self.max_tokens)
+        sizes = [self._estimate(r["content"]) for r in results]
+        order = sorted(range(len(results)), key=sizes.__getitem__)
+        for n, i in enumerate(order):
+            share = max(0, room) // (len(order) - n)
+            if sizes[i] > share:
+                text = results[i]["content"]
+                max_chars = max(MIN_HELD_PAGE_CHARS, len(text) * share // sizes[i])
+                results[i]["content"] = self.tool_executor.hold_output(text, max_chars)
+                sizes[i] = self._estimate(results[i]["content"])
+                self._vprint(f"\n  ** Held a {len(text):,}-char result; {max_chars:,} chars fit the context **")
+            room -= sizes[i]
 
     def _try_extract_json(self, text: str) -> dict | None:
         if not text:
@@ -0,0 +1,203 @@
+from __future__ import annotations
+
+import hashlib
+import json
+import logging
+import os
+import subprocess
+import tempfile
+import threading
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Any, Iterator
+
+from .sandbox import RunResult
+
+log = logging.getLogger(__name__)
+
+# Bump when the on-disk entry layout changes
+CACHE_FORMAT_VERSION = 1
+
+_digest_lock = threading.Lock()
+_image_digests: dict[str, str] = {}
+
+_hash_lock = threading.Lock()
+_file_hashes: dict[tuple[str, int, int], str] = {}
+
+_flights_lock = threading.Lock()
+_flights: dict[str, list] = {}   # key -> [lock, holders and waiters]
+
+
+def image_digest(image: str | None) -> str:
+    """Return the tools-image ID (memoized per process), or "local" without Docker."""
+    if not image:
+        return "local"
+    with _digest_lock:
+        if image in _image_digests:
+            return _image_digests[image]
+        digest = image
+        try:
+            proc = subprocess.run(
+                ["docker", "image", "inspect", "--format", "{{.Id}}", image],
+                capture_output=True,
+                text=True,
+                timeout=30,
+            )
+            if proc.returncode == 0 and proc.stdout.strip():
+                digest = proc.stdout.strip()
+        except (subprocess.TimeoutExpired, FileNotFoundError):
+            pass
+        _image_digests[image] = digest
+        return digest
+
+
+def file_sha256(path: Path) -> str:
+    """sha256 of a file's bytes, memoized on (path, size, mtime)."""
+    st = path.stat()
+    memo_key = (str(path), st.st_size, st.st_mtime_ns)
+    with _hash_lock:
+        cached = _file_hashes.get(memo_key)
+    if cached:
+        return cached
+    h = hashlib.sha256()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 20), b""):
+            h.update(chunk)
+    digest = h.hexdigest()
+    with _hash_lock:
+        _file_hashes[memo_key] = digest
+    return digest
+
+
+@contextmanager
+def single_flight(key: str) -> Iterator[None]:
+    """Serialize the lookup, run and store of one cache key within this process.
+
+    Concurrent tasks on the same binary (--trials, sweeps) ask for the same
+    commands at about the same time; the later callers wait for the first
+    and then read its result from the cache instead of running it again.
+    """
+    with _flights_lock:
+        flight = _flights.setdefault(key, [threading.Lock(), 0])
+        flight[1] += 1
+    try:
+        with flight[0]:
+            yield
+    finally:
+        with _flights_lock:
+            flight[1] -= 1
+            if not flight[1]:
+                del _flights[key]
+
+
+class ToolOutputCache:
+    """Content-addressed on-disk cache of sandbox results.
+
+    Entries are keyed by (binary sha256, tool, normalized command, tool
+    environment, output cap) and stored one JSON file per key. Access time is tracked
+    via file mtime so eviction is LRU across processes sharing the directory.
+    """
+
+    def __init__(self, cache_dir: Path, max_bytes: int = 512 * 1024 * 1024):
+        self.cache_dir = Path(cache_dir)
+        self.max_bytes = max_bytes
+        self._lock = threading.Lock()
+        self._approx_bytes: int | None = None  # lazily scanned, then tracked on put()
+        self.cache_dir.mkdir(parents=True, exist_ok=True)
+
+    def make_key(
+        self,
+        binary_sha256: str,
+        tool_name: str,
+        command: list[str],
+        environment: str,
+        max_output_chars: int,
+    ) -> str:
+        material = json.dumps(
+            [CACHE_FORMAT_VERSION, binary_sha256, tool_name, command, environment, max_output_chars],
+            separators=(",", ":"),
+        )
+        return hashlib.sha256(material.encode("utf-8")).hexdigest()
+
+    def _entry_path(self, key: str) -> Path:
+        return self.cache_dir / key[:2] / f"{key}.json"
+
+    def get(self, key: str) -> RunResult | None:
+        path = self._entry_path(key)
+        try:
+            with open(path) as f:
+                data = json.load(f)
+            os.utime(path)  # mark as recently used
+        except (OSError, json.JSONDecodeError):
+            return None
+        return RunResult(
+            stdout=data.get("stdout", ""),
+            stderr=data.get("stderr", ""),
+            returncode=data.get("returncode", 0),
+            truncated=data.get("truncated", False),
+            output_bytes=data.get("output_bytes", 0),
+            stopped_early=data.get("stopped_early", False),
+        )
+
+    def put(self, key: str, result: RunResult) -> None:
+        # Timeouts depend on host load and sandbox failures on the host, not
+        # on the binary — never cache them
+        if result.timed_out or result.sandbox_failed:
+            return
+        path = self._entry_path(key)
+        payload: dict[str, Any] = {
+            "stdout": result.stdout,
+            "stderr": result.stderr,
+            "returncode": result.returncode,
+            "truncated": result.truncated,
+            "output_bytes": result.output_bytes,
+            "stopped_early": result.stopped_early,
+        }
+        try:
+            path.parent.mkdir(parents=True, exist_ok=True)
+            fd, tmp = tempfile.mkstemp(dir=path.parent, suffix=".tmp")
+            with os.fdopen(fd, "w") as f:
+                json.dump(payload, f)
+            os.replace(tmp, path)
+            size = path.stat().st_size
+        except OSError as e:
+            log.warning("Tool cache write failed for %s: %s", key, e)
+            return
+
+        with self._lock:
+            if self._approx_bytes is None:
+                self._approx_bytes = self._scan()[1]
+            else:
+                self._approx_bytes += size
+            over = self._approx_bytes > self.max_bytes
+        if over:
+            self._evict()
+
+    def _scan(self) -> tuple[list[tuple[float, int, Path]], int]:
+        entries = []
+        total = 0
+        for p in self.cache_dir.glob("*/*.json"):
+            try:
+                st = p.stat()
+            except OSError:
+                continue
+            entries.append((st.st_mtime, st.st_size, p))
+            total += st.st_size
+        return entries, total
+
+    def _evict(self) -> None:
+        with self._lock:
+            entries, total = self._scan()
+            if total <= self.max_bytes:
+                self._approx_bytes = total
+                return
+            entries.sort()
+            for _, size, p in entries:
+                if total <= self.max_bytes:
+                    break
+                try:
+                    p.unlink()
+                    total -= size
+                except OSError:
+                    continue
+            self._approx_bytes = total
@@ -1,5 +1,7 @@
 from __future__ import annotations
 
+import hashlib
+import json
 import os
 from dataclasses import dataclass, field
 from pathlib import Path
@@ -13,7 +15,8 @@ ENV_KEY_MAP = {
 }
 
 DEFAULT_TOOLS = [
-    "file", "strings", "readelf", "objdump", "nm", "hexdump", "xxd", "entropy", "pefile",
+    "file", "strings", "section_strings", "readelf", "objdump", "disasm", "nm", "hexdump", "xxd",
+    "entropy", "pefile",
 ]
 
 
@@ -56,14 +59,39 @@ class BenchmarkConfig:
     max_tool_calls: int = 25
     tool_timeout_seconds: int = 30
     max_output_chars: int = 50000
+    paged_output: bool = False    # Hold large outputs and serve pages via read_more / grep_output
+    paged_output_max_chars: int = 4_000_000  # Capture limit for a held output
     max_tokens: int = 4096
+    token_budget: int = 0         # Per-task input+output token limit; 0 = none
+    context_tokens: int = 0       # Prompt size tool outputs are fitted to; 0 = the provider's context window
+    prompt_caching: bool = True   # Provider prompt-prefix caching (Anthropic breakpoints, OpenAI cache key)
+    streaming: bool = False       # SSE responses; tool calls start while the model is still generating
+    tool_parallelism: int = 1     # Max concurrent tool calls from one assistant turn
+    replay_latency: str = "none"  # --provider replay: "none", "recorded[*F]" or seconds per turn
 
     docker_image: str = "agentre-bench-tools:latest"
     use_docker: bool = True
+    pooled_sandbox: bool = False  # One container per task, tools via `docker exec`
+    container_pool: bool = False  # Reuse pooled containers across tasks instead of one start each (sweeps)
+
+    tool_cache_enabled: bool = True
+    tool_cache_dir: Path = field(default=None)  # default: <project_root>/.cache/tool_outputs
+    tool_cache_max_bytes: int = 512 * 1024 * 1024
+    binary_index_enabled: bool = True   # Serve tools from binaries/<name>.reidx when fresh
+    analysis_server: bool = True  # pefile / entropy / section_strings on a resident agentre-analyzer per task
+    prefetch_tools: list[str] = field(default_factory=list)  # "tool" / "tool:flags" run during the first model turn
 
     allowed_tools: list[str] = field(default_factory=lambda: list(DEFAULT_TOOLS))
 
+    jobs: int = 1                 # Tasks run concurrently
+    provider_concurrency: int = 0  # Max concurrent tasks per provider (0 = jobs)
+    requests_per_minute: int = 0  # Provider request budget shared by all tasks (0 = unlimited)
+    tokens_per_minute: int = 0    # Provider prompt-token budget, estimated from request size (0 = unlimited)
+    max_retries: int = 5          # Retries on 429 / transient 5xx / network errors before a task fails
+
     results_dir: Path = field(default=None)
+    compress_transcripts: bool = True   # transcripts/<task>.transcript.jsonl.gz vs plain .jsonl
+    resume: bool = False          # Reuse finished tasks and continue interrupted ones from transcripts
     verbose: bool = False
     langfuse_public_key: str = ""
     langfuse_secret_key: str = ""
@@ -75,9 +103,16 @@ class BenchmarkConfig:
         self.workspace_dir = Path(self.workspace_dir).resolve()
         self.ground_truths_dir = Path(self.ground_truths_dir).resolve()
 
+        if self.tool_cache_dir is None:
+            self.tool_cache_dir = self.project_root / ".cache" / "tool_outputs"
+        else:
+            self.tool_cache_dir = Path(self.tool_cache_dir).resolve()
+
         if self.results_dir is None:
             # Namespace by provider/model to avoid overwriting across runs
             safe_model = self.model.replace("/", "_").replace(":", "_")
+            if self.provider == "replay":
+                safe_model = Path(self.model).name   # the recorded run's directory
             self.results_dir = self.project_root / "results" / f"{self.provider}_{safe_model}"
         else:
             self.results_dir = Path(self.results_dir).resolve()
@@ -104,10 +139,37 @@ class BenchmarkConfig:
 
         self.langfuse_enabled = bool(self.langfuse_public_key and self.langfuse_secret_key)
 
+    def fingerprint(self) -> str:
+        """Hash of the settings that change what the model sees or how it is run.
+
+        --resume only reuses transcripts written under the same fingerprint.
+        """
+        relevant = {
+            "provider": self.provider,
+            "model": self.model,
+            "openai_base_url": self.openai_base_url,
+            "max_tool_calls": self.max_tool_calls,
+            "max_tokens": self.max_tokens,
+            "max_output_chars": self.max_output_chars,
+            "tool_timeout_seconds": self.tool_timeout_seconds,
+            "paged_output": self.paged_output,
+            "allowed_tools": sorted(self.allowed_tools),
+            "use_docker": self.use_docker,
+            "docker_image": self.docker_image if self.use_docker else "",
+        }
+        # Only when set, so fingerprints of runs without a budget are unchanged
+        if self.token_budgeted:
+            relevant["token_budget"] = self.token_budget
+            relevant["context_tokens"] = self.context_tokens
+        return hashlib.sha256(json.dumps(relevant, sort_keys=True).encode("utf-8")).hexdigest()[:16]
+
     def resolve_api_key(self) -> str:
         # 1. Explicit --api-key flag (highest priority)
         if self.api_key:
             return self.api_key
+        if self.provider == "replay":
+            return ""   # plays back transcripts, no API
+
         # 2. Environment variable (includes values loaded from .env)
         env_var = ENV_KEY_MAP.get(self.provider)
         if env_var:
@@ -120,6 +182,11 @@ class BenchmarkConfig:
             f"or pass --api-key."
         )
 
+    @property
+    def token_budgeted(self) -> bool:
+        """Tool outputs are fitted to the remaining context (and held for paging) before they are sent."""
+        return bool(self.token_budget or self.context_tokens)
+
     @property
     def agent_outputs_dir(self) -> Path:
         return self.results_dir / "agent_outputs"
@@ -0,0 +1,390 @@
+from __future__ import annotations
+
+import dataclasses
+import hashlib
+import json
+import logging
+import os
+import socket
+import threading
+import time
+import uuid
+from datetime import datetime, timezone
+from pathlib import Path
+from typing import Any
+
+from .config import BenchmarkConfig
+from .langfuse import create_langfuse_client
+from .metrics import TaskMetrics
+from .runner import (
+    TaskConfig,
+    load_tasks,
+    provider_slot,
+    run_single_task,
+    trial_config,
+    write_report,
+    write_trials_report,
+)
+
+log = logging.getLogger(__name__)
+
+DEFAULT_LEASE_SECONDS = 900
+MAX_ATTEMPTS = 3          # dispatches of one item before it is marked failed
+POLL_SECONDS = 5.0
+
+# Settings a worker takes from the queued run; paths, API keys, --jobs,
+# --resume and the tool cache stay the worker's own
+RUN_FIELDS = (
+    "provider", "model", "openai_base_url", "openai_custom_headers", "is_bedrock_anthropic",
+    "max_tool_calls", "tool_timeout_seconds", "max_output_chars", "paged_output",
+    "paged_output_max_chars", "max_tokens", "token_budget", "context_tokens",
+    "prompt_caching", "streaming", "tool_parallelism", "replay_latency",
+    "docker_image", "use_docker", "pooled_sandbox", "allowed_tools",
+    "requests_per_minute", "tokens_per_minute", "max_retries", "compress_transcripts",
+)
+STATES = ("pending", "leased", "done", "failed")
+
+
+class WorkQueue:
+    """(run, task, trial) work items as JSON files in a shared directory.
+
+    Items move pending/ -> leased/ -> done/ (or failed/). A worker claims one
+    by renaming it into leased/, which exactly one rename wins, and keeps the
+    lease alive by touching the file. Each claim writes a fresh lease token
+    into the file; renewing, completing or failing an item only touches a
+    lease that still carries the caller's token, so a worker whose item was
+    re-dispatched leaves the new holder alone. A lease untouched for `lease_seconds`
+    (dead or cut-off worker) is put back in pending/ by whichever process
+    notices; after MAX_ATTEMPTS dispatches the item goes to failed/. Results
+    are created with link(), so a stalled worker finishing after its item was
+    re-dispatched cannot overwrite the first result.
+
+    Needs only atomic rename/link on the shared filesystem (local disk,
+    NFSv3+). Lease expiry compares file mtimes with the local clock, so hosts
+    must agree on the time to well within `lease_seconds`.
+    """
+
+    def __init__(self, root: Path, lease_seconds: float = DEFAULT_LEASE_SECONDS):
+        self.root = Path(root)
+        self.lease_seconds = lease_seconds
+        for state in STATES + ("runs", "tmp"):
+            (self.root / state).mkdir(parents=True, exist_ok=True)
+
+    def _path(self, state: str, item_id: str) -> Path:
+        return self.root / state / f"{item_id}.json"
+
+    def _write(self, path: Path, data: dict, exclusive: bool = False) -> bool:
+        """Write atomically; with `exclusive`, only if `path` does not exist yet."""
+        tmp = self.root / "tmp" / f"{uuid.uuid4().hex}.json"
+        tmp.write_text(json.dumps(data, indent=2, default=str))
+        try:
+            if not exclusive:
+                os.replace(tmp, path)
+                return True
+            try:
+                os.link(tmp, path)
+            except FileExistsError:
+                return False
+            return True
+        finally:
+            tmp.unlink(missing_ok=True)
+
+    @staticmethod
+    def _read(path: Path) -> dict | None:
+        try:
+            return json.loads(path.read_text())
+        except (FileNotFoundError, json.JSONDecodeError):
+            return None
+
+    # ── Runs ──
+
+    def add_run(self, spec: dict[str, Any]) -> str:
+        run_id = hashlib.sha256(json.dumps(spec, sort_keys=True).encode("utf-8")).hexdigest()[:12]
+        self._write(self.root / "runs" / f"{run_id}.json", spec)
+        return run_id
+
+    def runs(self) -> dict[str, dict]:
+        return {p.stem: self._read(p) for p in sorted((self.root / "runs").glob("*.json"))}
+
+    # ── Items ──
+
+    def state_of(self, item_id: str) -> str | None:
+        for state in STATES:
+            if self._path(state, item_id).exists():
+                return state
+        return None
+
+    def enqueue(self, item: dict) -> bool:
+        """Add an item unless it is already queued, running or done; failed items are retried."""
+        state = self.state_of(item["id"])
+        if state in ("pending", "leased", "done"):
+            return False
+        if state == "failed":
+            self._path("failed", item["id"]).unlink(missing_ok=True)
+        return self._write(self._path("pending", item["id"]), {**item, "attempts": 0}, exclusive=True)
+
+    def claim(self, worker: str) -> dict | None:
+        self.reap_expired()
+        for path in sorted((self.root / "pending").glob("*.json")):
+            leased = self._path("leased", path.stem)
+            try:
+                # The rename keeps the mtime, and an item that waited longer than
+                # lease_seconds would look expired the moment it lands in leased/
+                os.utime(path)
+                os.rename(path, leased)
+            except FileNotFoundError:
+                continue  # another worker got it first
+            item = self._read(leased)
+            if item is None or self._path("done", path.stem).exists():
+                leased.unlink(missing_ok=True)   # finished by an earlier lease holder
+                continue
+            item.update(attempts=item.get("attempts", 0) + 1, worker=worker, leased_at=time.time(),
+                        lease=uuid.uuid4().hex)
+            self._write(leased, item)
+            return item
+        return None
+
+    def _holds(self, path: Path, item: dict) -> bool:
+        current = self._read(path)
+        return current is not None and current.get("lease") == item.get("lease")
+
+    def _take_lease(self, item: dict) -> Path | None:
+        """Move the caller's lease out of leased/ (into tmp/); None if the lease there is
+        someone else's, e.g. after this one was reaped and re-dispatched."""
+        path = self._path("leased", item["id"])
+        if not self._holds(path, item):
+            return None
+        taken = self.root / "tmp" / f"{item['id']}.{uuid.uuid4().hex}.released"
+        try:
+            os.rename(path, taken)
+        except FileNotFoundError:
+            return None
+        if not self._holds(taken, item):
+            os.rename(taken, path)   # re-dispatched between the check and the rename
+            return None
+        return taken
+
+    def renew(self, item: dict) -> bool:
+        """Heartbeat; False once the lease has been reaped."""
+        path = self._path("leased", item["id"])
+        if not self._holds(path, item):
+            return False
+        try:
+            os.utime(path)
+            return True
+        except FileNotFoundError:
+            return False
+
+    def complete(self, item: dict, result: dict) -> bool:
+        """Record a result; False if an earlier dispatch of the item already did."""
+        first = self._write(self._path("done", item["id"]), {**item, **result}, exclusive=True)
+        taken = self._take_lease(item)
+        if taken is not None:
+            taken.unlink(missing_ok=True)
+        return first
+
+    def fail(self, item: dict, error: str) -> None:
+        """Give the item back for another attempt, or mark it failed after MAX_ATTEMPTS.
+
+        Does nothing if the lease has passed to another worker, which is
+        still running the item.
+        """
+        taken = self._take_lease(item)
+        if taken is not None:
+            self._requeue(taken, {**item, "error": error})
+
+    def reap_expired(self) -> int:
+        reaped = 0
+        now = time.time()
+        for path in (self.root / "leased").glob("*.json"):
+            try:
+                if now - path.stat().st_mtime <= self.lease_seconds:
+                    continue
+                claimed = self.root / "tmp" / f"{path.stem}.{uuid.uuid4().hex}.reaped"
+                os.rename(path, claimed)   # one reaper wins
+            except FileNotFoundError:
+                continue
+            item = self._read(claimed) or {"id": path.stem}
+            log.warning("Lease on %s (worker %s) expired; re-dispatching", path.stem, item.get("worker"))
+            self._requeue(claimed, {**item, "error": f"lease expired on worker {item.get('worker')}"})
+            reaped += 1
+        return reaped
+
+    def _requeue(self, current: Path, item: dict) -> None:
+        if not self._path("done", item["id"]).exists():
+            state = "failed" if item.get("attempts", 0) >= MAX_ATTEMPTS else "pending"
+            self._write(self._path(state, item["id"]), item)
+        current.unlink(missing_ok=True)
+
+    def counts(self) -> dict[str, int]:
+        return {state: sum(1 for _ in (self.root / state).glob("*.json")) for state in STATES}
+
+    def items(self, state: str) -> list[dict]:
+        return [item for p in sorted((self.root / state).glob("*.json")) if (item := self._read(p))]
+
+
+def run_spec(config: BenchmarkConfig) -> dict[str, Any]:
+    """The queued description of one benchmark run (no API keys)."""
+    results_dir = config.results_dir
+    if results_dir.is_relative_to(config.project_root):
+        results_dir = results_dir.relative_to(config.project_root)   # resolved per worker checkout
+    return {
+        **{name: getattr(config, name) for name in RUN_FIELDS},
+        "results_dir": str(results_dir),
+        "config_hash": config.fingerprint(),
+    }
+
+
+def run_config(base: BenchmarkConfig, spec: dict[str, Any], trial: int, resume: bool = False) -> BenchmarkConfig:
+    """`base` (this host's paths and keys) with a queued run's settings; trial N writes to trial_N/."""
+    results_dir = Path(spec["results_dir"])
+    if not results_dir.is_absolute():
+        results_dir = base.project_root / results_dir
+    config = trial_config(dataclasses.replace(
+        base,
+        **{name: spec[name] for name in RUN_FIELDS if name in spec},
+        results_dir=results_dir,
+    ), trial)
+    config.resume = config.resume or resume
+    if config.fingerprint() != spec.get("config_hash"):
+        log.warning("Run %s/%s resolves to a different config on this host (e.g. OPENAI_BASE_URL)",
+                    config.provider, config.model)
+    return config
+
+
+def enqueue(queue: WorkQueue, config: BenchmarkConfig, tasks: list[TaskConfig], trials: int = 1) -> tuple[str, int]:
+    """Queue every (task, trial) of one run; returns (run_id, items added)."""
+    run_id = queue.add_run(run_spec(config))
+    added = 0
+    for trial in range(max(1, trials)):
+        for task in tasks:
+            added += queue.enqueue({
+                "id": f"{run_id}_{task.task_id}_t{trial}",
+                "run_id": run_id,
+                "task_id": task.task_id,
+                "trial": trial,
+            })
+    return run_id, added
+
+
+def run_worker(queue: WorkQueue, base: BenchmarkConfig, worker_id: str | None = None) -> int:
+    """Run queued items on `base.jobs` threads until none are pending or leased; returns items completed."""
+    worker_id = worker_id or f"{socket.gethostname()}:{os.getpid()}"
+    tasks = {t.task_id: t for t in load_tasks(base.project_root / "tasks.json", base.project_root)}
+    jobs = max(1, base.jobs)
+    langfuse_client = create_langfuse_client(
+        public_key=base.langfuse_public_key,
+        secret_key=base.langfuse_secret_key,
+        host=base.langfuse_host,
+    )
+    held: dict[str, dict] = {}
+    held_lock = threading.Lock()
+    stop = threading.Event()
+    completed = 0
+
+    def heartbeat() -> None:
+        while not stop.wait(queue.lease_seconds / 3):
+            with held_lock:
+                for item in list(held.values()):
+                    if not queue.renew(item):
+                        log.warning("[%s] Lease on %s was reaped; finishing it anyway", worker_id, item["id"])
+
+    def process(item: dict) -> None:
+        nonlocal completed
+        spec = queue.runs().get(item["run_id"])
+        task = tasks.get(item["task_id"])
+        if spec is None or task is None:
+            queue.fail({**item, "attempts": MAX_ATTEMPTS}, "unknown run or task on this worker")
+            return
+        # A re-dispatched item continues from its transcript if the results directory is shared
+        config = run_config(base, spec, item["trial"], resume=item["attempts"] > 1)
+        label = f"{config.provider}/{config.model} {task.task_id} trial {item['trial']}"
+        try:
+            with provider_slot(config.provider, config.provider_concurrency or jobs):
+                metrics, score_result = run_single_task(task, config, langfuse_client=langfuse_client,
+                                                        progress_callback=lambda: None)
+        except Exception as e:
+            log.error("[%s] %s failed: %s", worker_id, label, e, exc_info=True)
+            queue.fail(item, str(e))
+            print(f"  {label}: FAILED (attempt {item['attempts']}/{MAX_ATTEMPTS})", flush=True)
+            return
+        first = queue.complete(item, {
+            "metrics": metrics.to_dict(),
+            "score": score_result,
+            "finished_at": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+        })
+        with held_lock:
+            completed += first
+        print(f"  {label}: {metrics.score:.4f} ({metrics.tool_calls_total} calls, "
+              f"{metrics.wall_time_seconds:.1f}s){'' if first else ' (duplicate, dropped)'}", flush=True)
+
+    def loop() -> None:
+        while True:
+            item = queue.claim(worker_id)
+            if item is None:
+                if not queue.counts()["leased"]:
+                    return
+                time.sleep(POLL_SECONDS)   # other workers' leases may still expire
+                continue
+            with held_lock:
+                held[item["id"]] = item
+            try:
+                process(item)
+            finally:
+                with held_lock:
+                    held.pop(item["id"], None)
+
+    beat = threading.Thread(target=heartbeat, name="lease-heartbeat", daemon=True)
+    beat.start()
+    threads = [threading.Thread(target=loop, name=f"worker-{i}") for i in range(jobs)]
+    try:
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    finally:
+        stop.set()
+        langfuse_client.shutdown()
+    return completed
+
+
+def merge(queue: WorkQueue, base: BenchmarkConfig, wait: bool = True) -> list[Path]:
+    """Write one benchmark_report.json per (run, trial) from the queue's results, and a
+    trials_report.json per run queued with several trials."""
+    while wait:
+        counts = queue.counts()
+        if not counts["pending"] and not counts["leased"]:
+            break
+        queue.reap_expired()
+        print(f"  Waiting: {counts['pending']} pending, {counts['leased']} running, "
+              f"{counts['done']} done, {counts['failed']} failed", flush=True)
+        time.sleep(POLL_SECONDS)
+
+    order = [t.task_id for t in load_tasks(base.project_root / "tasks.json", base.project_root)]
+    done: dict[tuple[str, int], dict[str, dict]] = {}
+    for record in queue.items("done"):
+        done.setdefault((record["run_id"], record["trial"]), {})[record["task_id"]] = record
+
+    reports = []
+    runs = queue.runs()
+    trial_reports: dict[str, tuple[list[TaskMetrics], dict[int, Path]]] = {}
+    for (run_id, trial), records in sorted(done.items()):
+        if run_id not in runs:
+            continue
+        config = run_config(base, runs[run_id], trial)
+        ordered = [records[task_id] for task_id in order if task_id in records]
+        metrics = [dataclasses.replace(TaskMetrics.from_dict(r["metrics"]), trial=trial) for r in ordered]
+        aggregate, path = write_report(config, metrics, [r["score"] for r in ordered])
+        print(f"  {config.provider}/{config.model} trial {trial}: {aggregate.total_score:.4f} "
+              f"({len(ordered)}/{len(order)} tasks) -> {path}")
+        reports.append(path)
+        run_metrics, paths = trial_reports.setdefault(run_id, ([], {}))
+        run_metrics.extend(metrics)
+        paths[trial] = path
+    for run_id, (run_metrics, paths) in trial_reports.items():
+        if len(paths) > 1:
+            _, path = write_trials_report(run_config(base, runs[run_id], 0), run_metrics, paths)
+            reports.append(path)
+    for item in queue.items("failed"):
+        print(f"  FAILED: {item['task_id']} trial {item['trial']} of run {item['run_id']}: {item.get('error')}")
+    return reports
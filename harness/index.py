@@ -0,0 +1,277 @@
+from __future__ import annotations
+
+import hashlib
+import json
+import logging
+import mmap
+import os
+import re
+import shutil
+import signal
+import struct
+import subprocess
+import tempfile
+import threading
+from pathlib import Path
+
+from .cache import file_sha256, image_digest
+from .sandbox import RunResult, _truncate, bytes_read_before_stop
+
+log = logging.getLogger(__name__)
+
+INDEX_MAGIC = b"AGENTREIDX\x01"
+INDEX_FORMAT_VERSION = 1
+INDEX_SUFFIX = ".reidx"
+
+# Stands in for the binary's sandbox path inside stored output; tools print
+# the path (objdump, file) and it differs between Docker and local runs.
+PATH_TOKEN = b"\x00<binary>\x00"
+
+_FUNCTION_RE = re.compile(rb"^([0-9a-f]+) <([^>]+)>:$", re.MULTILINE)
+# objdump -t function symbols: address, flags, F, section, size, name
+_FUNC_SYMBOL_RE = re.compile(rb"^([0-9a-f]+) .{6}F \S+\s+([0-9a-f]+) (?:\.hidden )?(.+)$", re.MULTILINE)
+_INSN_ADDR_RE = re.compile(r"^\s*([0-9a-f]+):")
+
+# Native helper built from tools/entropy.c and baked into Dockerfile.tools
+ENTROPY_HELPER = "agentre-entropy"
+
+# pefile, section_strings, and entropy without the native helper, run on
+# tools/analyzer.py (installed in the image as agentre-analyzer). With the analysis server on,
+# all three go to one resident instance per task that keeps the binary loaded.
+ANALYZER = "agentre-analyzer"
+ANALYZER_SCRIPT = Path(__file__).resolve().parent.parent / "tools" / "analyzer.py"
+
+_local_env: str | None = None
+_local_env_lock = threading.Lock()
+
+
+def index_path(binary_path: Path) -> Path:
+    return binary_path.with_name(binary_path.name + INDEX_SUFFIX)
+
+
+def tool_environment(use_docker: bool, image: str | None) -> str:
+    """Identity of the tool environment an index was captured in.
+
+    Docker mode uses the tools image digest. Locally it is a hash of the
+    installed tool versions and of the analyzer and entropy helpers, so
+    upgrading binutils or editing tools/analyzer.py invalidates indexes
+    (and tool-output cache entries, which are keyed on it too).
+    """
+    if use_docker:
+        return "docker:" + image_digest(image)
+
+    global _local_env
+    with _local_env_lock:
+        if _local_env is None:
+            h = hashlib.sha256()
+            for tool in (["readelf", "--version"], ["objdump", "--version"], ["nm", "--version"],
+                         ["strings", "--version"], ["file", "--version"]):
+                try:
+                    out = subprocess.run(tool, capture_output=True, timeout=10).stdout
+                except (OSError, subprocess.TimeoutExpired):
+                    out = b"missing"
+                h.update(out.split(b"\n", 1)[0] + b"\n")
+            for helper in (shutil.which(ANALYZER) or ANALYZER_SCRIPT, shutil.which(ENTROPY_HELPER)):
+                try:
+                    h.update(file_sha256(Path(helper)).encode() if helper else b"missing")
+                except OSError:
+                    h.update(b"missing")
+                h.update(b"\n")
+            _local_env = "local:" + h.hexdigest()[:16]
+        return _local_env
+
+
+def command_key(normalized_cmd: list[str]) -> str:
+    return json.dumps(normalized_cmd)
+
+
+class BinaryIndex:
+    """Read side of a per-binary pre-analysis index.
+
+    Layout: INDEX_MAGIC, a little-endian u64 header length, a JSON header,
+    then the raw output blobs. The header maps each normalized tool command
+    (binary path replaced by "<binary>") to byte ranges in the blob area, and
+    records the binary hash and tool environment it was built from. The file
+    is memory-mapped; a lookup slices the stored output and applies the same
+    truncation the runners would.
+    """
+
+    def __init__(self, path: Path, header: dict, mm: mmap.mmap, data_start: int):
+        self.path = path
+        self.header = header
+        self._mm = mm
+        self._data_start = data_start
+        self.entries: dict[str, dict] = header.get("entries", {})
+        self.functions: dict[str, list[int]] = header.get("functions", {})
+        self._function_ends: dict[str, int] | None = None
+
+    @classmethod
+    def open(cls, binary_path: Path, environment: str) -> "BinaryIndex | None":
+        """Load the index for `binary_path`, or None if missing or stale."""
+        path = index_path(binary_path)
+        try:
+            with open(path, "rb") as f:
+                mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        except (OSError, ValueError):
+            return None
+
+        try:
+            if mm[:len(INDEX_MAGIC)] != INDEX_MAGIC:
+                raise ValueError("bad magic")
+            offset = len(INDEX_MAGIC)
+            (header_len,) = struct.unpack_from("<Q", mm, offset)
+            offset += 8
+            header = json.loads(mm[offset:offset + header_len])
+        except (ValueError, struct.error) as e:
+            log.debug("Ignoring unreadable index %s: %s", path, e)
+            mm.close()
+            return None
+
+        if header.get("version") != INDEX_FORMAT_VERSION:
+            reason = "format version"
+        elif header.get("binary_sha256") != file_sha256(binary_path):
+            reason = "binary changed"
+        elif header.get("environment") != environment:
+            reason = "tool environment changed"
+        else:
+            return cls(path, header, mm, offset + header_len)
+
+        log.debug("Ignoring stale index %s (%s)", path, reason)
+        mm.close()
+        return None
+
+    def _slice(self, span: list[int]) -> bytes:
+        start = self._data_start + span[0]
+        return self._mm[start:start + span[1]]
+
+    def lookup(self, normalized_cmd: list[str], sandbox_path: str, max_output_chars: int) -> RunResult | None:
+        entry = self.entries.get(command_key(normalized_cmd))
+        if entry is None:
+            return None
+        real_path = sandbox_path.encode("utf-8")
+        stdout_raw = self._slice(entry["stdout"]).replace(PATH_TOKEN, real_path)
+        stderr_raw = self._slice(entry["stderr"]).replace(PATH_TOKEN, real_path)
+        return stored_result(stdout_raw, stderr_raw, entry["returncode"], max_output_chars)
+
+    def function_disassembly(self, name: str, sandbox_path: str = "") -> str | None:
+        """`objdump -d` text of one function, from the stored full disassembly.
+
+        Like `objdump --disassemble=name`, the block ends at the symbol's size
+        (from the stored `objdump -t`), dropping alignment padding after it.
+        """
+        span = self.functions.get(name)
+        entry = self.entries.get(command_key(["objdump", "-d", "<binary>"]))
+        if span is None or entry is None:
+            return None
+        blob = self._slice(entry["stdout"])
+        text = blob[span[0]:span[0] + span[1]].replace(PATH_TOKEN, sandbox_path.encode("utf-8"))
+        text = text.decode("utf-8", errors="replace")
+
+        end = self._symbol_ends().get(name)
+        if end is None:
+            return text
+        lines = text.splitlines(keepends=True)
+        for i, line in enumerate(lines[1:], 1):
+            m = _INSN_ADDR_RE.match(line)
+            if m and int(m.group(1), 16) >= end:
+                return "".join(lines[:i])
+        return text
+
+    def _symbol_ends(self) -> dict[str, int]:
+        if self._function_ends is None:
+            ends: dict[str, int] = {}
+            entry = self.entries.get(command_key(["objdump", "-t", "<binary>"]))
+            if entry is not None:
+                for m in _FUNC_SYMBOL_RE.finditer(self._slice(entry["stdout"])):
+                    size = int(m.group(2), 16)
+                    if size:
+                        ends.setdefault(m.group(3).decode("utf-8", errors="replace"), int(m.group(1), 16) + size)
+            self._function_ends = ends
+        return self._function_ends
+
+    def close(self) -> None:
+        self._mm.close()
+
+
+def stored_result(stdout_raw: bytes, stderr_raw: bytes, returncode: int, max_output_chars: int) -> RunResult:
+    """A stored run as the runner would have returned it.
+
+    The runner kills a tool once stdout passes the limit, so a longer stdout
+    comes back as a SIGKILL with output_bytes counting what was read by then.
+    """
+    stdout, out_truncated = _truncate(stdout_raw.decode("utf-8", errors="replace"), max_output_chars)
+    stderr, err_truncated = _truncate(stderr_raw.decode("utf-8", errors="replace"), max_output_chars)
+    read = bytes_read_before_stop(stdout_raw, max_output_chars) if out_truncated else len(stdout_raw)
+    return RunResult(
+        stdout=stdout,
+        stderr=stderr,
+        returncode=-signal.SIGKILL if out_truncated else returncode,
+        truncated=out_truncated or err_truncated,
+        output_bytes=read + len(stderr_raw),
+        stopped_early=out_truncated,
+    )
+
+
+def write_index(
+    binary_path: Path,
+    environment: str,
+    outputs: dict[str, tuple[RunResult, str]],
+) -> Path:
+    """Write an index from {command_key: (result, sandbox_path)} captured at build time."""
+    entries: dict[str, dict] = {}
+    blobs: list[bytes] = []
+    offset = 0
+    functions: dict[str, list[int]] = {}
+
+    for key, (result, sandbox_path) in outputs.items():
+        token_path = sandbox_path.encode("utf-8")
+        spans = {}
+        for stream in ("stdout", "stderr"):
+            data = getattr(result, stream).encode("utf-8").replace(token_path, PATH_TOKEN)
+            spans[stream] = [offset, len(data)]
+            blobs.append(data)
+            offset += len(data)
+        entries[key] = {**spans, "returncode": result.returncode}
+
+        if key == command_key(["objdump", "-d", "<binary>"]):
+            functions = _function_spans(blobs[-2])
+
+    header = {
+        "version": INDEX_FORMAT_VERSION,
+        "binary": binary_path.name,
+        "binary_sha256": file_sha256(binary_path),
+        "environment": environment,
+        "entries": entries,
+        "functions": functions,
+    }
+    header_bytes = json.dumps(header).encode("utf-8")
+
+    path = index_path(binary_path)
+    fd, tmp = tempfile.mkstemp(dir=path.parent, suffix=".tmp")
+    try:
+        os.chmod(tmp, 0o644)
+        with os.fdopen(fd, "wb") as f:
+            f.write(INDEX_MAGIC)
+            f.write(struct.pack("<Q", len(header_bytes)))
+            f.write(header_bytes)
+            for blob in blobs:
+                f.write(blob)
+        os.replace(tmp, path)
+    except BaseException:
+        os.unlink(tmp)
+        raise
+    return path
+
+
+def _function_spans(disassembly: bytes) -> dict[str, list[int]]:
+    """Byte ranges of each `<name>:` block in objdump -d output."""
+    matches = list(_FUNCTION_RE.finditer(disassembly))
+    spans: dict[str, list[int]] = {}
+    for i, m in enumerate(matches):
+        end = matches[i + 1].start() if i + 1 < len(matches) else len(disassembly)
+        # Stop at the blank line before a section header, if any
+        block = disassembly[m.start():end]
+        cut = block.find(b"\n\nDisassembly of section")
+        length = cut + 1 if cut >= 0 else len(block)
+        spans.setdefault(m.group(2).decode("utf-8", errors="replace"), [m.start(), length])
+    return spans
@@ -1,15 +1,23 @@
 from __future__ import annotations
 
 import base64
+import hashlib
 import json
 import logging
+import queue
+import threading
+import time
 import uuid
 from datetime import datetime, timezone
 from typing import Any
-import urllib.request
+
+from .providers.transport import ConnectionPool
 
 log = logging.getLogger(__name__)
 
+# Langfuse rejects ingestion batches larger than ~3.5 MB
+MAX_BATCH_BYTES = 3_000_000
+
 
 def _now_iso() -> str:
     return datetime.now(timezone.utc).isoformat()
@@ -39,11 +47,33 @@ class NoopLangfuseClient:
     def create_event(self, trace_id: str | None, **kwargs) -> None:
         return None
 
+    def flush(self, timeout: float | None = None) -> bool:
+        return True
+
+    def shutdown(self, timeout: float | None = None) -> None:
+        return None
+
 
 class LangfuseClient:
+    """Raw-HTTP Langfuse ingestion client.
+
+    Events are queued and sent by a background thread in batches, so the agent
+    loop never waits on the Langfuse host. If the queue fills up (host down or
+    very slow) new events are dropped rather than blocking. Call `shutdown()`
+    before exit to flush what is left.
+    """
+
     enabled = True
 
-    def __init__(self, public_key: str, secret_key: str, host: str = "https://cloud.langfuse.com"):
+    def __init__(
+        self,
+        public_key: str,
+        secret_key: str,
+        host: str = "https://cloud.langfuse.com",
+        max_queue: int = 10000,
+        batch_size: int = 100,
+        flush_interval: float = 1.0,
+    ):
         self.public_key = public_key
         self.secret_key = secret_key
         self.host = host.rstrip("/")
@@ -51,6 +81,22 @@ class LangfuseClient:
         self._auth_header = f"Basic {token}"
         self._warned = False
 
+        self.batch_size = batch_size
+        self.flush_interval = flush_interval
+        self.sent = 0
+        self.dropped = 0
+        self._queue: queue.Queue[str | None] = queue.Queue(maxsize=max_queue)   # JSON-encoded events
+        self._pool = ConnectionPool(max_idle_per_host=1)
+        self._closed = False
+
+        # Per-trace state for delta-encoded generation inputs:
+        # trace_id -> (messages already sent, previous generation id, system+tools digest)
+        self._generation_state: dict[str, tuple[int, str, str]] = {}
+        self._state_lock = threading.Lock()
+
+        self._worker = threading.Thread(target=self._run, name="langfuse-emitter", daemon=True)
+        self._worker.start()
+
     def _truncate(self, value: Any, max_chars: int = 12000) -> Any:
         text = json.dumps(value, default=str) if isinstance(value, (dict, list, tuple)) else str(value)
         if len(text) <= max_chars:
@@ -58,31 +104,97 @@ class LangfuseClient:
         return text[:max_chars] + "... [truncated]"
 
     def _emit(self, event_type: str, body: dict[str, Any]) -> None:
-        payload = {
-            "batch": [
-                {
-                    "id": str(uuid.uuid4()),
-                    "type": event_type,
-                    "timestamp": _now_iso(),
-                    "body": body,
-                }
-            ],
-            "metadata": {"sdk_integration": "agentre-bench-raw-http"},
-        }
-        data = json.dumps(payload, default=str).encode("utf-8")
+        if self._closed:
+            return
+        # Encoded here, on the caller's thread: the body may hold live objects
+        # (e.g. the agent's message list) that change before the emitter runs
+        event = json.dumps({
+            "id": str(uuid.uuid4()),
+            "type": event_type,
+            "timestamp": _now_iso(),
+            "body": body,
+        }, default=str)
+        try:
+            self._queue.put_nowait(event)
+        except queue.Full:
+            self.dropped += 1
+            self._warn(f"queue full, dropping {event_type}")
+
+    def _warn(self, reason: Any) -> None:
+        if not self._warned:
+            log.warning("Langfuse emission failed (suppressing further warnings): %s", reason)
+            self._warned = True
+
+    def _run(self) -> None:
+        stop = False
+        while not stop:
+            try:
+                first = self._queue.get(timeout=self.flush_interval)
+            except queue.Empty:
+                continue
+            if first is None:
+                self._queue.task_done()
+                break
+
+            batch = [first]
+            batch_bytes = len(first)
+            deadline = time.monotonic() + self.flush_interval
+            while len(batch) < self.batch_size and batch_bytes < MAX_BATCH_BYTES:
+                try:
+                    event = self._queue.get(timeout=max(0.0, deadline - time.monotonic()))
+                except queue.Empty:
+                    break
+                if event is None:
+                    stop = True
+                    self._queue.task_done()
+                    break
+                batch.append(event)
+                batch_bytes += len(event)
+
+            self._send(batch)
+            for _ in batch:
+                self._queue.task_done()
+
+    def _send(self, batch: list[str]) -> None:
+        metadata = json.dumps({"sdk_integration": "agentre-bench-raw-http"})
+        data = f'{{"batch":[{",".join(batch)}],"metadata":{metadata}}}'.encode("utf-8")
         headers = {
             "Content-Type": "application/json",
             "Authorization": self._auth_header,
         }
         url = f"{self.host}/api/public/ingestion"
-        req = urllib.request.Request(url, data=data, headers=headers, method="POST")
         try:
-            with urllib.request.urlopen(req, timeout=15):
-                pass
+            resp = self._pool.request("POST", url, body=data, headers=headers, timeout=15)
+            if resp.status >= 400:
+                self._warn(f"HTTP {resp.status}: {resp.body[:200]!r}")
+            else:
+                self.sent += len(batch)
         except Exception as e:
-            if not self._warned:
-                log.warning("Langfuse emission failed (suppressing further warnings): %s", e)
-                self._warned = True
+            self._warn(e)
+
+    def flush(self, timeout: float | None = 30.0) -> bool:
+        """Block until every queued event has been sent (or `timeout` passes)."""
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while self._queue.unfinished_tasks:
+            if deadline is not None and time.monotonic() >= deadline:
+                return False
+            time.sleep(0.05)
+        return True
+
+    def shutdown(self, timeout: float | None = 30.0) -> None:
+        """Flush pending events and stop the emitter thread."""
+        if self._closed:
+            return
+        flushed = self.flush(timeout)
+        self._closed = True
+        try:
+            self._queue.put_nowait(None)
+        except queue.Full:
+            pass
+        self._worker.join(timeout=1.0)
+        self._pool.close()
+        if not flushed:
+            log.warning("Langfuse flush timed out; %d events not sent", self._queue.qsize())
 
     def create_task_trace(
         self,
@@ -144,7 +256,7 @@ class LangfuseClient:
             "traceId": trace_id,
             "name": name,
             "model": model,
-            "input": self._truncate(input),
+            "input": self._truncate(self._delta_input(trace_id, generation_id, input)),
         }
         if metadata is not None:
             body["metadata"] = self._truncate(metadata)
@@ -153,6 +265,38 @@ class LangfuseClient:
         self._emit("generation-create", body)
         return generation_id
 
+    def _delta_input(self, trace_id: str, generation_id: str, input: Any) -> Any:
+        """Replace the already-sent part of a generation's message history.
+
+        The agent appends to one message list, so each turn's input repeats the
+        previous one. The first generation of a trace carries the full input;
+        later ones carry only messages added since, plus the id of the previous
+        generation. System prompt and tools are included again only if they
+        changed.
+        """
+        if not isinstance(input, dict) or not isinstance(input.get("messages"), list):
+            return input
+        messages = input["messages"]
+        digest = hashlib.sha256(
+            json.dumps([input.get("system"), input.get("tools")], sort_keys=True, default=str).encode("utf-8")
+        ).hexdigest()
+
+        with self._state_lock:
+            previous = self._generation_state.get(trace_id)
+            self._generation_state[trace_id] = (len(messages), generation_id, digest)
+
+        if previous is None or previous[0] > len(messages):
+            return input
+        sent, previous_id, previous_digest = previous
+        # Reference fields first so they survive truncation of a large delta
+        delta: dict[str, Any] = {"previous_generation_id": previous_id, "messages_offset": sent}
+        delta.update((k, v) for k, v in input.items() if k != "messages")
+        if digest == previous_digest:
+            delta.pop("system", None)
+            delta.pop("tools", None)
+        delta["messages_delta"] = messages[sent:]
+        return delta
+
     def end_generation(
         self,
         trace_id: str | None,
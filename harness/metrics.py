@@ -1,8 +1,15 @@
 from __future__ import annotations
 
+import random
 import statistics
-from dataclasses import dataclass, field
-from typing import Any
+from collections import defaultdict
+from dataclasses import dataclass, field, fields
+from typing import Any, Callable
+
+from .timing import merge_samples, percentile, summarize
+
+BOOTSTRAP_RESAMPLES = 2000
+BOOTSTRAP_CONFIDENCE = 0.95
 
 
 @dataclass
@@ -11,6 +18,7 @@ class TaskMetrics:
     score: float                    # final_score from scorer
     tier: str                       # "standard" or "bonus"
     field_scores: dict[str, float] = field(default_factory=dict)
+    trial: int = 0                  # repetition of the task under --trials
 
     tool_calls_total: int = 0
     tool_calls_by_type: dict[str, int] = field(default_factory=dict)
@@ -20,6 +28,9 @@ class TaskMetrics:
     steps_to_answer: int = 0
     max_steps_hit: bool = False
     has_valid_answer: bool = False
+    token_budget: int = 0             # per-task token limit (0 = none)
+    token_budget_hit: bool = False    # stopped because the next turn would pass token_budget
+    max_prompt_tokens: int = 0        # largest single prompt sent
 
     hallucinated_techniques: list[str] = field(default_factory=list)
     hallucination_count: int = 0
@@ -29,6 +40,48 @@ class TaskMetrics:
     total_tokens: int = 0
     input_tokens: int = 0
     output_tokens: int = 0
+    cache_read_tokens: int = 0      # subset of input_tokens served from the prompt cache
+    cache_write_tokens: int = 0     # subset of input_tokens written to the prompt cache
+
+    # Sandbox timing (startup is only non-zero for the pooled runner)
+    sandbox_startup_seconds: float = 0.0
+    sandbox_exec_seconds: float = 0.0
+    sandbox_output_bytes: int = 0     # bytes tools wrote (lower bound for early stops)
+    sandbox_early_stops: int = 0      # tools killed once output passed max_output_chars
+
+    # Tool-output cache
+    tool_cache_hits: int = 0
+    tool_cache_misses: int = 0
+    tool_index_hits: int = 0          # calls answered from the build-time index
+    paged_outputs: int = 0            # outputs split into pages (--paged-output)
+    page_requests: int = 0            # read_more / grep_output calls
+    page_reruns_avoided: int = 0      # repeated commands served from a held output
+    held_outputs: int = 0             # results cut to fit the context, the rest held for paging
+    held_chars: int = 0               # characters kept out of the prompt that way
+    prefetch_runs: int = 0            # --prefetch inspections run in the background
+    prefetch_hits: int = 0            # model calls answered by one
+    prefetch_saved_seconds: float = 0.0  # tool time those calls did not wait for
+
+    # Provider HTTP connections (TCP + TLS setup)
+    http_connect_seconds: float = 0.0
+    http_new_connections: int = 0
+    http_reused_connections: int = 0
+
+    # Provider rate limiting: time spent waiting on the shared limiter or backing off
+    throttle_wait_seconds: float = 0.0
+    provider_retries: int = 0
+
+    # Per-step latency breakdown (TTFT/generation are only non-zero when streaming)
+    llm_steps: int = 0
+    llm_seconds_total: float = 0.0
+    ttft_seconds_avg: float = 0.0
+    generation_seconds_total: float = 0.0
+    first_tool_call_seconds_avg: float = 0.0   # request sent -> first tool call complete
+    tool_dispatch_latency_avg: float = 0.0     # tool call complete -> execution started
+
+    # Raw seconds per phase (llm, http, tool, sandbox_exec, langfuse, ...); to_dict
+    # adds their count/total/p50/p95/p99/max as phase_timings
+    phase_samples: dict[str, list[float]] = field(default_factory=dict)
 
     # Error tracking
     error_occurred: bool = False
@@ -36,12 +89,18 @@ class TaskMetrics:
     error_message: str = ""
     http_status_code: int = 0  # 0 if not HTTP error
 
+    @classmethod
+    def from_dict(cls, data: dict[str, Any]) -> "TaskMetrics":
+        """Inverse of to_dict (used to reuse finished tasks on --resume)."""
+        return cls(**{f.name: data[f.name] for f in fields(cls) if f.name in data})
+
     def to_dict(self) -> dict[str, Any]:
         return {
             "task_id": self.task_id,
             "score": self.score,
             "tier": self.tier,
             "field_scores": self.field_scores,
+            "trial": self.trial,
             "tool_calls_total": self.tool_calls_total,
             "tool_calls_by_type": self.tool_calls_by_type,
             "redundant_tool_calls": self.redundant_tool_calls,
@@ -50,6 +109,9 @@ class TaskMetrics:
             "steps_to_answer": self.steps_to_answer,
             "max_steps_hit": self.max_steps_hit,
             "has_valid_answer": self.has_valid_answer,
+            "token_budget": self.token_budget,
+            "token_budget_hit": self.token_budget_hit,
+            "max_prompt_tokens": self.max_prompt_tokens,
             "hallucinated_techniques": self.hallucinated_techniques,
             "hallucination_count": self.hallucination_count,
             "missing_techniques": self.missing_techniques,
@@ -57,6 +119,36 @@ class TaskMetrics:
             "total_tokens": self.total_tokens,
             "input_tokens": self.input_tokens,
             "output_tokens": self.output_tokens,
+            "cache_read_tokens": self.cache_read_tokens,
+            "cache_write_tokens": self.cache_write_tokens,
+            "sandbox_startup_seconds": self.sandbox_startup_seconds,
+            "sandbox_exec_seconds": self.sandbox_exec_seconds,
+            "sandbox_output_bytes": self.sandbox_output_bytes,
+            "sandbox_early_stops": self.sandbox_early_stops,
+            "tool_cache_hits": self.tool_cache_hits,
+            "tool_cache_misses": self.tool_cache_misses,
+            "tool_index_hits": self.tool_index_hits,
+            "paged_outputs": self.paged_outputs,
+            "page_requests": self.page_requests,
+            "page_reruns_avoided": self.page_reruns_avoided,
+            "held_outputs": self.held_outputs,
+            "held_chars": self.held_chars,
+            "prefetch_runs": self.prefetch_runs,
+            "prefetch_hits": self.prefetch_hits,
+            "prefetch_saved_seconds": self.prefetch_saved_seconds,
+            "http_connect_seconds": self.http_connect_seconds,
+            "http_new_connections": self.http_new_connections,
+            "http_reused_connections": self.http_reused_connections,
+            "throttle_wait_seconds": self.throttle_wait_seconds,
+            "provider_retries": self.provider_retries,
+            "llm_steps": self.llm_steps,
+            "llm_seconds_total": self.llm_seconds_total,
+            "ttft_seconds_avg": self.ttft_seconds_avg,
+            "generation_seconds_total": self.generation_seconds_total,
+            "first_tool_call_seconds_avg": self.first_tool_call_seconds_avg,
+            "tool_dispatch_latency_avg": self.tool_dispatch_latency_avg,
+            "phase_timings": summarize(self.phase_samples),
+            "phase_samples": self.phase_samples,
             "error_occurred": self.error_occurred,
             "error_type": self.error_type,
             "error_message": self.error_message,
@@ -83,11 +175,50 @@ class AggregateMetrics:
 
     total_wall_time: float = 0.0
     total_tokens: int = 0
+    total_input_tokens: int = 0
+    total_cache_read_tokens: int = 0
+    total_cache_write_tokens: int = 0
+    prompt_cache_hit_rate: float = 0.0   # cache_read / input tokens
     max_steps_hit_count: int = 0
+    token_budget_hit_count: int = 0
+    max_prompt_tokens: int = 0
+
+    total_sandbox_startup_seconds: float = 0.0
+    total_sandbox_exec_seconds: float = 0.0
+    total_sandbox_output_bytes: int = 0
+    sandbox_early_stops: int = 0
+    tool_cache_hits: int = 0
+    tool_cache_misses: int = 0
+    tool_cache_hit_rate: float = 0.0
+    tool_index_hits: int = 0
+    paged_outputs: int = 0
+    page_requests: int = 0
+    page_reruns_avoided: int = 0
+    held_outputs: int = 0
+    held_chars: int = 0
+    prefetch_runs: int = 0
+    prefetch_hits: int = 0
+    prefetch_hit_rate: float = 0.0       # hits / runs
+    total_prefetch_saved_seconds: float = 0.0
+    total_http_connect_seconds: float = 0.0
+    http_new_connections: int = 0
+    http_reused_connections: int = 0
+    total_throttle_wait_seconds: float = 0.0
+    provider_retries: int = 0
+    total_llm_seconds: float = 0.0
+    avg_ttft_seconds: float = 0.0
+    total_generation_seconds: float = 0.0
+    avg_first_tool_call_seconds: float = 0.0
+    avg_tool_dispatch_latency: float = 0.0
+    phase_timings: dict[str, dict[str, float | int]] = field(default_factory=dict)  # pooled over tasks
 
     tasks_run: int = 0
     tasks_with_answer: int = 0
 
+    # Repeated trials: {statistic: {mean, std, ci_low, ci_high}} across trials
+    trials: int = 1
+    trial_stats: dict[str, dict[str, float]] = field(default_factory=dict)
+
     # Error tracking aggregates
     total_errors: int = 0
     errors_by_type: dict[str, int] = field(default_factory=dict)  # "timeout", "context_overflow", "http_400", etc.
@@ -111,9 +242,45 @@ class AggregateMetrics:
             "episode_length_median": round(self.episode_length_median, 2),
             "total_wall_time": round(self.total_wall_time, 2),
             "total_tokens": self.total_tokens,
+            "total_input_tokens": self.total_input_tokens,
+            "total_cache_read_tokens": self.total_cache_read_tokens,
+            "total_cache_write_tokens": self.total_cache_write_tokens,
+            "prompt_cache_hit_rate": round(self.prompt_cache_hit_rate, 4),
             "max_steps_hit_count": self.max_steps_hit_count,
+            "token_budget_hit_count": self.token_budget_hit_count,
+            "max_prompt_tokens": self.max_prompt_tokens,
+            "total_sandbox_startup_seconds": round(self.total_sandbox_startup_seconds, 2),
+            "total_sandbox_exec_seconds": round(self.total_sandbox_exec_seconds, 2),
+            "total_sandbox_output_bytes": self.total_sandbox_output_bytes,
+            "sandbox_early_stops": self.sandbox_early_stops,
+            "tool_cache_hits": self.tool_cache_hits,
+            "tool_cache_misses": self.tool_cache_misses,
+            "tool_cache_hit_rate": round(self.tool_cache_hit_rate, 4),
+            "tool_index_hits": self.tool_index_hits,
+            "paged_outputs": self.paged_outputs,
+            "page_requests": self.page_requests,
+            "page_reruns_avoided": self.page_reruns_avoided,
+            "held_outputs": self.held_outputs,
+            "held_chars": self.held_chars,
+            "prefetch_runs": self.prefetch_runs,
+            "prefetch_hits": self.prefetch_hits,
+            "prefetch_hit_rate": round(self.prefetch_hit_rate, 4),
+            "total_prefetch_saved_seconds": round(self.total_prefetch_saved_seconds, 2),
+            "total_http_connect_seconds": round(self.total_http_connect_seconds, 2),
+            "http_new_connections": self.http_new_connections,
+            "http_reused_connections": self.http_reused_connections,
+            "total_throttle_wait_seconds": round(self.total_throttle_wait_seconds, 2),
+            "provider_retries": self.provider_retries,
+            "total_llm_seconds": round(self.total_llm_seconds, 2),
+            "avg_ttft_seconds": round(self.avg_ttft_seconds, 3),
+            "total_generation_seconds": round(self.total_generation_seconds, 2),
+            "avg_first_tool_call_seconds": round(self.avg_first_tool_call_seconds, 3),
+            "avg_tool_dispatch_latency": round(self.avg_tool_dispatch_latency, 3),
+            "phase_timings": self.phase_timings,
             "tasks_run": self.tasks_run,
             "tasks_with_answer": self.tasks_with_answer,
+            "trials": self.trials,
+            "trial_stats": self.trial_stats,
             "total_errors": self.total_errors,
             "errors_by_type": self.errors_by_type,
             "errors_by_http_status": self.errors_by_http_status,
@@ -122,6 +289,63 @@ class AggregateMetrics:
         }
 
 
+def _mean(values: list[float]) -> float:
+    return sum(values) / len(values) if values else 0.0
+
+
+def _total_score(task_metrics: list[TaskMetrics]) -> float:
+    return (_mean([m.score for m in task_metrics if m.tier == "standard"])
+            + _mean([m.score for m in task_metrics if m.tier == "bonus"]))
+
+
+# Summarized across --trials: name -> value over one trial's tasks
+TRIAL_STATISTICS: dict[str, Callable[[list[TaskMetrics]], float]] = {
+    "total_score": _total_score,
+    "success_rate": lambda ms: _mean([float(m.has_valid_answer) for m in ms]),
+    "avg_tool_calls_per_task": lambda ms: _mean([m.tool_calls_total for m in ms]),
+    "avg_tokens_per_task": lambda ms: _mean([m.total_tokens for m in ms]),
+    "avg_wall_time_per_task": lambda ms: _mean([m.wall_time_seconds for m in ms]),
+    "avg_llm_seconds_per_task": lambda ms: _mean([m.llm_seconds_total for m in ms]),
+}
+
+
+def trial_statistics(task_metrics: list[TaskMetrics], seed: int = 0) -> dict[str, dict[str, float]]:
+    """Mean and standard deviation over the per-trial values of each TRIAL_STATISTICS
+    entry, with a bootstrap confidence interval for the mean.
+
+    Each bootstrap replicate redraws every task's trials with replacement
+    (so it still holds each task as often as the data does) and evaluates
+    the statistic on the pooled draw; the interval is the central
+    BOOTSTRAP_CONFIDENCE of BOOTSTRAP_RESAMPLES replicates. Seeded, so a
+    report's numbers can be reproduced from its task metrics.
+    """
+    by_trial: dict[int, list[TaskMetrics]] = defaultdict(list)
+    by_task: dict[str, list[TaskMetrics]] = defaultdict(list)
+    for m in task_metrics:
+        by_trial[m.trial].append(m)
+        by_task[m.task_id].append(m)
+
+    rng = random.Random(seed)
+    replicates: dict[str, list[float]] = {name: [] for name in TRIAL_STATISTICS}
+    for _ in range(BOOTSTRAP_RESAMPLES):
+        draw = [m for runs in by_task.values() for m in rng.choices(runs, k=len(runs))]
+        for name, statistic in TRIAL_STATISTICS.items():
+            replicates[name].append(statistic(draw))
+
+    tail = (1 - BOOTSTRAP_CONFIDENCE) / 2 * 100
+    stats = {}
+    for name, statistic in TRIAL_STATISTICS.items():
+        values = [statistic(runs) for runs in by_trial.values()]
+        ordered = sorted(replicates[name])
+        stats[name] = {
+            "mean": round(statistics.mean(values), 4),
+            "std": round(statistics.stdev(values), 4) if len(values) > 1 else 0.0,
+            "ci_low": round(percentile(ordered, tail), 4),
+            "ci_high": round(percentile(ordered, 100 - tail), 4),
+        }
+    return stats
+
+
 def collect_task_metrics(
     task_id: str,
     agent_result: dict[str, Any],
@@ -136,6 +360,14 @@ def collect_task_metrics(
     error_message = error_info.get("error_message", "")
     http_status_code = error_info.get("http_status_code", 0)
 
+    sandbox_stats = agent_result.get("sandbox_stats", {})
+    cache_stats = agent_result.get("tool_cache_stats", {})
+    http_stats = agent_result.get("http_stats", {})
+
+    steps = agent_result.get("step_timings", [])
+    first_tool = [t["first_tool_call_seconds"] for t in steps if t.get("first_tool_call_seconds") is not None]
+    dispatch = [d for t in steps for d in t.get("tool_dispatch_latency", [])]
+
     return TaskMetrics(
         task_id=task_id,
         score=score_result.get("final_score", 0.0),
@@ -149,6 +381,9 @@ def collect_task_metrics(
         steps_to_answer=agent_result.get("tool_call_count", 0),
         max_steps_hit=agent_result.get("max_steps_hit", False),
         has_valid_answer=agent_result.get("has_valid_answer", False),
+        token_budget=agent_result.get("token_budget", 0),
+        token_budget_hit=agent_result.get("token_budget_hit", False),
+        max_prompt_tokens=agent_result.get("max_prompt_tokens", 0),
         hallucinated_techniques=hallucinated,
         hallucination_count=len(hallucinated),
         missing_techniques=score_result.get("missing_techniques", []),
@@ -156,6 +391,35 @@ def collect_task_metrics(
         total_tokens=agent_result.get("total_tokens", 0),
         input_tokens=agent_result.get("input_tokens", 0),
         output_tokens=agent_result.get("output_tokens", 0),
+        cache_read_tokens=agent_result.get("cache_read_tokens", 0),
+        cache_write_tokens=agent_result.get("cache_write_tokens", 0),
+        sandbox_startup_seconds=sandbox_stats.get("startup_seconds", 0.0),
+        sandbox_exec_seconds=sandbox_stats.get("exec_seconds", 0.0),
+        sandbox_output_bytes=sandbox_stats.get("output_bytes", 0),
+        sandbox_early_stops=sandbox_stats.get("early_stops", 0),
+        tool_cache_hits=cache_stats.get("hits", 0),
+        tool_cache_misses=cache_stats.get("misses", 0),
+        tool_index_hits=cache_stats.get("index_hits", 0),
+        paged_outputs=cache_stats.get("paged_outputs", 0),
+        page_requests=cache_stats.get("page_requests", 0),
+        page_reruns_avoided=cache_stats.get("page_reruns_avoided", 0),
+        held_outputs=cache_stats.get("held_outputs", 0),
+        held_chars=cache_stats.get("held_chars", 0),
+        prefetch_runs=cache_stats.get("prefetch_runs", 0),
+        prefetch_hits=cache_stats.get("prefetch_hits", 0),
+        prefetch_saved_seconds=cache_stats.get("prefetch_saved_seconds", 0.0),
+        http_connect_seconds=http_stats.get("connect_seconds", 0.0),
+        http_new_connections=http_stats.get("new_connections", 0),
+        http_reused_connections=http_stats.get("reused_connections", 0),
+        throttle_wait_seconds=http_stats.get("throttle_seconds", 0.0),
+        provider_retries=http_stats.get("retries", 0),
+        llm_steps=len(steps),
+        llm_seconds_total=round(sum(t.get("llm_seconds", 0.0) for t in steps), 3),
+        ttft_seconds_avg=round(_mean([t.get("ttft_seconds", 0.0) for t in steps]), 3),
+        generation_seconds_total=round(sum(t.get("generation_seconds", 0.0) for t in steps), 3),
+        first_tool_call_seconds_avg=round(_mean(first_tool), 3),
+        tool_dispatch_latency_avg=round(_mean(dispatch), 3),
+        phase_samples=agent_result.get("phase_samples", {}),
         error_occurred=error_occurred,
         error_type=error_type,
         error_message=error_message,
@@ -180,7 +444,7 @@ def compute_aggregate(task_metrics: list[TaskMetrics]) -> AggregateMetrics:
     agg.main_score = (
         sum(m.score for m in standard) / len(standard) if standard else 0.0
     )
-    agg.bonus_score = bonus[0].score if bonus else 0.0
+    agg.bonus_score = _mean([m.score for m in bonus])   # one bonus task per trial
     agg.total_score = agg.main_score + agg.bonus_score
 
     # Tool call stats
@@ -216,7 +480,55 @@ def compute_aggregate(task_metrics: list[TaskMetrics]) -> AggregateMetrics:
 
     agg.total_wall_time = sum(times)
     agg.total_tokens = sum(m.total_tokens for m in task_metrics)
+    agg.total_input_tokens = sum(m.input_tokens for m in task_metrics)
+    agg.total_cache_read_tokens = sum(m.cache_read_tokens for m in task_metrics)
+    agg.total_cache_write_tokens = sum(m.cache_write_tokens for m in task_metrics)
+    agg.prompt_cache_hit_rate = (
+        agg.total_cache_read_tokens / agg.total_input_tokens if agg.total_input_tokens else 0.0
+    )
     agg.max_steps_hit_count = sum(1 for m in task_metrics if m.max_steps_hit)
+    agg.token_budget_hit_count = sum(1 for m in task_metrics if m.token_budget_hit)
+    agg.max_prompt_tokens = max(m.max_prompt_tokens for m in task_metrics)
+    agg.total_sandbox_startup_seconds = sum(m.sandbox_startup_seconds for m in task_metrics)
+    agg.total_sandbox_exec_seconds = sum(m.sandbox_exec_seconds for m in task_metrics)
+    agg.total_sandbox_output_bytes = sum(m.sandbox_output_bytes for m in task_metrics)
+    agg.sandbox_early_stops = sum(m.sandbox_early_stops for m in task_metrics)
+    agg.tool_cache_hits = sum(m.tool_cache_hits for m in task_metrics)
+    agg.tool_cache_misses = sum(m.tool_cache_misses for m in task_metrics)
+    lookups = agg.tool_cache_hits + agg.tool_cache_misses
+    agg.tool_cache_hit_rate = agg.tool_cache_hits / lookups if lookups else 0.0
+    agg.tool_index_hits = sum(m.tool_index_hits for m in task_metrics)
+    agg.paged_outputs = sum(m.paged_outputs for m in task_metrics)
+    agg.page_requests = sum(m.page_requests for m in task_metrics)
+    agg.page_reruns_avoided = sum(m.page_reruns_avoided for m in task_metrics)
+    agg.held_outputs = sum(m.held_outputs for m in task_metrics)
+    agg.held_chars = sum(m.held_chars for m in task_metrics)
+    agg.prefetch_runs = sum(m.prefetch_runs for m in task_metrics)
+    agg.prefetch_hits = sum(m.prefetch_hits for m in task_metrics)
+    agg.prefetch_hit_rate = agg.prefetch_hits / agg.prefetch_runs if agg.prefetch_runs else 0.0
+    agg.total_prefetch_saved_seconds = sum(m.prefetch_saved_seconds for m in task_metrics)
+    agg.total_http_connect_seconds = sum(m.http_connect_seconds for m in task_metrics)
+    agg.http_new_connections = sum(m.http_new_connections for m in task_metrics)
+    agg.http_reused_connections = sum(m.http_reused_connections for m in task_metrics)
+    agg.total_throttle_wait_seconds = sum(m.throttle_wait_seconds for m in task_metrics)
+    agg.provider_retries = sum(m.provider_retries for m in task_metrics)
+
+    # Latency breakdown, weighted by the number of steps / tool calls per task
+    total_steps = sum(m.llm_steps for m in task_metrics)
+    total_calls = sum(m.tool_calls_total for m in task_metrics)
+    agg.total_llm_seconds = sum(m.llm_seconds_total for m in task_metrics)
+    agg.total_generation_seconds = sum(m.generation_seconds_total for m in task_metrics)
+    if total_steps:
+        agg.avg_ttft_seconds = sum(m.ttft_seconds_avg * m.llm_steps for m in task_metrics) / total_steps
+        agg.avg_first_tool_call_seconds = (
+            sum(m.first_tool_call_seconds_avg * m.llm_steps for m in task_metrics) / total_steps
+        )
+    if total_calls:
+        agg.avg_tool_dispatch_latency = (
+            sum(m.tool_dispatch_latency_avg * m.tool_calls_total for m in task_metrics) / total_calls
+        )
+    # Percentiles over every task's samples pooled, not an average of per-task percentiles
+    agg.phase_timings = summarize(merge_samples(*(m.phase_samples for m in task_metrics)))
 
     # Error aggregation
     agg.total_errors = sum(1 for m in task_metrics if m.error_occurred)
@@ -249,4 +561,8 @@ def compute_aggregate(task_metrics: list[TaskMetrics]) -> AggregateMetrics:
     agg.context_overflow_errors = context_overflow_count
     agg.timeout_errors = timeout_count
 
+    agg.trials = len({m.trial for m in task_metrics})
+    if agg.trials > 1:
+        agg.trial_stats = trial_statistics(task_metrics)
+
     return agg
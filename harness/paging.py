@@ -0,0 +1,134 @@
+from __future__ import annotations
+
+import re
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass, field
+
+
+@dataclass
+class StoredOutput:
+    cursor: str
+    text: str
+    complete: bool                 # False if capture stopped at the store limit
+    page_starts: list[int] = field(default_factory=list)
+    next_page: int = 1             # 0-based index of the page read_more returns by default
+
+    @property
+    def pages(self) -> int:
+        return len(self.page_starts)
+
+    def page(self, index: int) -> str:
+        start = self.page_starts[index]
+        end = self.page_starts[index + 1] if index + 1 < self.pages else len(self.text)
+        return self.text[start:end]
+
+
+class OutputPager:
+    """Full tool outputs kept per command, served a page at a time.
+
+    Pages break on line boundaries where possible and hold at most
+    `page_chars` characters. Stored outputs are evicted oldest-first once
+    they add up to more than `max_total_chars`.
+    """
+
+    def __init__(self, page_chars: int, max_total_chars: int = 64_000_000):
+        self.page_chars = max(1, page_chars)
+        self.max_total_chars = max_total_chars
+        self._by_cursor: OrderedDict[str, StoredOutput] = OrderedDict()
+        self._by_command: dict[str, str] = {}
+        self._total = 0
+        self._next_id = 1
+        self._lock = threading.Lock()
+
+    def needs_paging(self, text: str) -> bool:
+        return len(text) > self.page_chars
+
+    def store(self, command_key: str, text: str, complete: bool, page_chars: int | None = None) -> StoredOutput:
+        """Hold `text` under `command_key`; `page_chars` overrides the page size for this output."""
+        with self._lock:
+            existing = self._by_command.get(command_key)
+            if existing is not None and existing in self._by_cursor:
+                return self._by_cursor[existing]
+
+            cursor = f"out{self._next_id}"
+            self._next_id += 1
+            stored = StoredOutput(cursor, text, complete, self._page_starts(text, page_chars or self.page_chars))
+            self._by_cursor[cursor] = stored
+            self._by_command[command_key] = cursor
+            self._total += len(text)
+            while self._total > self.max_total_chars and len(self._by_cursor) > 1:
+                _, old = self._by_cursor.popitem(last=False)
+                self._total -= len(old.text)
+            return stored
+
+    @property
+    def next_id(self) -> int:
+        """Number of the next cursor handed out (out<N>)."""
+        with self._lock:
+            return self._next_id
+
+    def skip_to(self, next_id: int) -> None:
+        """Number new cursors from `next_id` on, so ones issued before a resume stay
+        unknown instead of naming a different output."""
+        with self._lock:
+            self._next_id = max(self._next_id, next_id)
+
+    def lookup_command(self, command_key: str) -> StoredOutput | None:
+        with self._lock:
+            cursor = self._by_command.get(command_key)
+            return self._by_cursor.get(cursor) if cursor else None
+
+    def get(self, cursor: str) -> StoredOutput | None:
+        with self._lock:
+            return self._by_cursor.get(cursor)
+
+    def _page_starts(self, text: str, page_chars: int) -> list[int]:
+        page_chars = max(1, page_chars)
+        starts = [0]
+        pos = 0
+        while len(text) - pos > page_chars:
+            end = pos + page_chars
+            newline = text.rfind("\n", pos, end)
+            pos = newline + 1 if newline > pos else end
+            starts.append(pos)
+        return starts
+
+
+def grep_lines(text: str, pattern: str, context: int, max_matches: int, limit_chars: int) -> tuple[str, int]:
+    """`grep -n -C context` over stored text. Returns (output, total matches).
+
+    `pattern` is a regular expression; one that does not compile is matched
+    literally. Output stops at `max_matches` matches or `limit_chars`.
+    """
+    try:
+        regex = re.compile(pattern)
+    except re.error:
+        regex = re.compile(re.escape(pattern))
+
+    lines = text.splitlines()
+    hits = [i for i, line in enumerate(lines) if regex.search(line)]
+    hit_set = set(hits)
+
+    out: list[str] = []
+    size = 0
+    last = -1
+    shown = 0
+    for i in hits:
+        if shown >= max_matches:
+            break
+        shown += 1
+        # Lines already printed as context of the previous match are skipped
+        lo, hi = max(0, i - context, last + 1), min(len(lines), i + context + 1)
+        if lo >= hi:
+            continue
+        if context and out and lo > last + 1:
+            out.append("--")
+        chunk = [f"{n + 1}{':' if n in hit_set else '-'}{lines[n]}" for n in range(lo, hi)]
+        chunk_size = sum(len(c) + 1 for c in chunk)
+        if size + chunk_size > limit_chars and out:
+            break
+        out.extend(chunk)
+        size += chunk_size
+        last = hi - 1
+    return "\n".join(out), len(hits)
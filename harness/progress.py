@@ -0,0 +1,55 @@
+from __future__ import annotations
+
+import sys
+import threading
+from typing import TextIO
+
+
+class ProgressBoard:
+    """One status line per task, redrawn in place as concurrent tasks progress.
+
+    On a TTY every task gets a fixed line that is rewritten with ANSI cursor
+    movement. When output is redirected, lines are printed once, on completion,
+    so logs stay readable.
+    """
+
+    def __init__(self, labels: list[str], stream: TextIO | None = None):
+        self.stream = stream or sys.stdout
+        self.labels = labels
+        self.dots = [0] * len(labels)
+        self.status = ["queued" for _ in labels]
+        self.interactive = self.stream.isatty()
+        self._lock = threading.Lock()
+        if self.interactive:
+            for i in range(len(labels)):
+                self.stream.write(self._line(i) + "\n")
+            self.stream.flush()
+
+    def _line(self, i: int) -> str:
+        return f"{self.labels[i]} {'.' * self.dots[i]} {self.status[i]}".rstrip()
+
+    def _redraw(self, i: int) -> None:
+        up = len(self.labels) - i
+        self.stream.write(f"\x1b[{up}A\r\x1b[K{self._line(i)}\x1b[{up}B\r")
+        self.stream.flush()
+
+    def start(self, i: int) -> None:
+        with self._lock:
+            self.status[i] = ""
+            if self.interactive:
+                self._redraw(i)
+
+    def tick(self, i: int) -> None:
+        with self._lock:
+            self.dots[i] += 1
+            if self.interactive:
+                self._redraw(i)
+
+    def finish(self, i: int, status: str) -> None:
+        with self._lock:
+            self.status[i] = status
+            if self.interactive:
+                self._redraw(i)
+            else:
+                self.stream.write(self._line(i) + "\n")
+                self.stream.flush()
@@ -4,6 +4,8 @@ from .openai_provider import OpenAIProvider
 from .openrouter import OpenRouterProvider
 from .gemini import GeminiProvider
 from .deepseek import DeepSeekProvider
+from .ratelimit import RateLimiter, rate_limiter
+from .replay import ReplayProvider, parse_latency_model
 
 PROVIDER_MAP = {
     "anthropic": AnthropicProvider,
@@ -11,6 +13,7 @@ PROVIDER_MAP = {
     "openrouter": OpenRouterProvider,
     "gemini": GeminiProvider,
     "deepseek": DeepSeekProvider,
+    "replay": ReplayProvider,
 }
 
 
@@ -21,6 +24,10 @@ def create_provider(
     base_url: str | None = None,
     is_bedrock_anthropic: bool = False,
     custom_headers: dict[str, str] | None = None,
+    prompt_caching: bool = True,
+    limiter: RateLimiter | None = None,
+    task_id: str | None = None,
+    replay_latency: str = "none",
 ) -> AgentProvider:
     cls = PROVIDER_MAP.get(provider_name)
     if cls is None:
@@ -37,5 +44,16 @@ def create_provider(
             kwargs["is_bedrock_anthropic"] = is_bedrock_anthropic
         if custom_headers:
             kwargs["custom_headers"] = custom_headers
-        return cls(**kwargs)
-    return cls(api_key=api_key, model=model)
+        kwargs["prompt_caching"] = prompt_caching
+        provider = cls(**kwargs)
+    elif provider_name == "replay":
+        # `model` is the recorded run's results directory; each task plays back its own transcript
+        provider = cls(api_key=api_key, model=model, task_id=task_id,
+                       latency=parse_latency_model(replay_latency))
+    elif provider_name == "gemini":
+        # Gemini caches implicitly; there is no per-request switch
+        provider = cls(api_key=api_key, model=model)
+    else:
+        provider = cls(api_key=api_key, model=model, prompt_caching=prompt_caching)
+    provider.limiter = limiter
+    return provider
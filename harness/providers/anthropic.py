@@ -2,49 +2,118 @@ from __future__ import annotations
 
 import json
 import logging
+import time
 import urllib.error
-import urllib.request
 
-from .base import AgentProvider, ProviderResponse, ToolCall
+from .base import AgentProvider, ProviderResponse, ToolCall, ToolCallCallback, parse_tool_input
+from .transport import iter_sse
 
 log = logging.getLogger(__name__)
 
 API_URL = "https://api.anthropic.com/v1/messages"
 API_VERSION = "2023-06-01"
 
+CACHE_CONTROL = {"type": "ephemeral"}
+
+
+def _with_cache_breakpoint(message: dict) -> dict:
+    """Copy of `message` with cache_control on its last content block."""
+    content = message["content"]
+    if isinstance(content, str):
+        blocks = [{"type": "text", "text": content}]
+    else:
+        blocks = [dict(b) if isinstance(b, dict) else {"type": "text", "text": str(b)} for b in content]
+    if blocks:
+        blocks[-1]["cache_control"] = CACHE_CONTROL
+    return {**message, "content": blocks}
+
 
 class AnthropicProvider(AgentProvider):
-    def __init__(self, api_key: str, model: str):
+    supports_streaming = True
+    context_window = 200_000
+    chars_per_token = 3.5
+
+    def __init__(self, api_key: str, model: str, prompt_caching: bool = True):
         self.api_key = api_key
         self.model = model
+        self.prompt_caching = prompt_caching
 
-    def create_message(
+    @staticmethod
+    def _cached_tools(tools: list[dict]) -> list[dict]:
+        cached_tools = list(tools)
+        if cached_tools:
+            cached_tools[-1] = {**cached_tools[-1], "cache_control": CACHE_CONTROL}
+        return cached_tools
+
+    def _request(
         self,
         system: str,
         messages: list[dict],
         tools: list[dict],
-        max_tokens: int = 4096,
-    ) -> ProviderResponse:
+        max_tokens: int,
+        **extra,
+    ) -> tuple[bytes, dict[str, str]]:
+        """Encoded body and headers. Messages are encoded once per conversation
+        and the tool list once per task (see MessageEncoder).
+
+        With prompt caching, breakpoints go on the system prompt, the tool list
+        and the latest message, so each turn re-reads everything before the
+        newest tool results from cache instead of re-prefilling it. The latest
+        message is encoded apart from the cached ones, since its copy
+        carries the breakpoint.
+        """
+        encoder = self._message_encoder(lambda message: [message])
+        if self.prompt_caching:
+            system_param = [{"type": "text", "text": system, "cache_control": CACHE_CONTROL}]
+            encoded_tools = lambda: self._tools_json(tools, self._cached_tools)
+            encoded_messages = lambda: encoder.encode(
+                messages[:-1], tail=[_with_cache_breakpoint(messages[-1])] if messages else [],
+            )
+        else:
+            system_param = system
+            encoded_tools = lambda: self._tools_json(tools, list)
+            encoded_messages = lambda: encoder.encode(messages)
+
         body = {
             "model": self.model,
             "max_tokens": max_tokens,
-            "system": system,
-            "messages": messages,
-            "tools": tools,
+            "system": system_param,
+            **extra,
         }
+        data = self._encode(body, {"messages": encoded_messages, "tools": encoded_tools})
 
         headers = {
             "Content-Type": "application/json",
             "x-api-key": self.api_key,
             "anthropic-version": API_VERSION,
         }
+        return data, headers
+
+    @staticmethod
+    def _usage_tokens(usage: dict) -> dict[str, int]:
+        cache_read = usage.get("cache_read_input_tokens", 0) or 0
+        cache_write = usage.get("cache_creation_input_tokens", 0) or 0
+        return {
+            # input_tokens excludes cached tokens here; count the full prompt
+            # so totals stay comparable with uncached runs and other providers
+            "input_tokens": (usage.get("input_tokens", 0) or 0) + cache_read + cache_write,
+            "output_tokens": usage.get("output_tokens", 0) or 0,
+            "cache_read_tokens": cache_read,
+            "cache_write_tokens": cache_write,
+        }
 
-        data = json.dumps(body).encode("utf-8")
-        req = urllib.request.Request(API_URL, data=data, headers=headers, method="POST")
+    def create_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+    ) -> ProviderResponse:
+        data, headers = self._request(system, messages, tools, max_tokens)
 
         try:
-            with urllib.request.urlopen(req, timeout=300) as resp:
-                result = json.loads(resp.read().decode("utf-8"))
+            resp = self._post(API_URL, data, headers)
+            result = json.loads(resp.body.decode("utf-8"))
         except urllib.error.HTTPError as e:
             error_body = e.read().decode("utf-8", errors="replace")
             log.error("Anthropic API error %d: %s", e.code, error_body)
@@ -65,12 +134,92 @@ class AnthropicProvider(AgentProvider):
                     )
                 )
 
-        usage = result.get("usage", {})
-
         return ProviderResponse(
             stop_reason=result.get("stop_reason", "end_turn"),
             text_content="\n".join(text_parts),
             tool_calls=tool_calls,
-            input_tokens=usage.get("input_tokens", 0),
-            output_tokens=usage.get("output_tokens", 0),
+            **self._usage_tokens(result.get("usage", {})),
+            connect_seconds=resp.connect_seconds,
+            connection_reused=resp.reused,
+        )
+
+    def stream_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+        on_tool_call: ToolCallCallback | None = None,
+    ) -> ProviderResponse:
+        data, headers = self._request(system, messages, tools, max_tokens, stream=True)
+
+        try:
+            stream = self._post_stream(API_URL, data, headers)
+        except urllib.error.HTTPError as e:
+            error_body = e.read().decode("utf-8", errors="replace")
+            log.error("Anthropic API error %d: %s", e.code, error_body)
+            raise
+        sent = self.sent_at   # the attempt that succeeded, after any throttling
+
+        blocks: dict[int, dict] = {}
+        usage: dict = {}
+        stop_reason = "end_turn"
+        first_content: float | None = None
+
+        with stream:
+            for event, payload in iter_sse(stream.iter_lines()):
+                msg = json.loads(payload)
+                kind = msg.get("type", event)
+
+                if kind == "message_start":
+                    usage.update(msg.get("message", {}).get("usage", {}))
+                elif kind == "content_block_start":
+                    if first_content is None:
+                        first_content = time.monotonic()
+                    block = dict(msg.get("content_block", {}))
+                    block["_json"] = []
+                    blocks[msg["index"]] = block
+                elif kind == "content_block_delta":
+                    if first_content is None:
+                        first_content = time.monotonic()
+                    block = blocks.setdefault(msg["index"], {"type": "text", "text": "", "_json": []})
+                    delta = msg.get("delta", {})
+                    if delta.get("type") == "text_delta":
+                        block["text"] = block.get("text", "") + delta.get("text", "")
+                    elif delta.get("type") == "input_json_delta":
+                        block["_json"].append(delta.get("partial_json", ""))
+                elif kind == "content_block_stop":
+                    block = blocks.get(msg["index"])
+                    if block and block.get("type") == "tool_use":
+                        raw = "".join(block["_json"])
+                        block["input"] = parse_tool_input(raw) if raw else block.get("input") or {}
+                        if on_tool_call is not None:
+                            on_tool_call(ToolCall(id=block["id"], name=block["name"], input=block["input"]))
+                elif kind == "message_delta":
+                    stop_reason = msg.get("delta", {}).get("stop_reason") or stop_reason
+                    usage.update(msg.get("usage", {}))
+                elif kind == "error":
+                    err = msg.get("error", {})
+                    raise RuntimeError(
+                        f"Anthropic stream error ({err.get('type', 'unknown')}): {err.get('message', payload)}"
+                    )
+        done = time.monotonic()
+
+        text_parts = []
+        tool_calls = []
+        for _, block in sorted(blocks.items()):
+            if block.get("type") == "text":
+                text_parts.append(block.get("text", ""))
+            elif block.get("type") == "tool_use":
+                tool_calls.append(ToolCall(id=block["id"], name=block["name"], input=block.get("input", {})))
+
+        return ProviderResponse(
+            stop_reason=stop_reason,
+            text_content="\n".join(text_parts),
+            tool_calls=tool_calls,
+            **self._usage_tokens(usage),
+            connect_seconds=stream.connect_seconds,
+            connection_reused=stream.reused,
+            ttft_seconds=(first_content or done) - sent,
+            generation_seconds=done - (first_content or done),
         )
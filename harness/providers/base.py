@@ -1,7 +1,26 @@
 from __future__ import annotations
 
+import json
+import logging
+import time
+import urllib.error
 from abc import ABC, abstractmethod
 from dataclasses import dataclass, field
+from typing import Any, Callable, Iterable, TypeVar
+
+from ..timing import PhaseTimer
+from .ratelimit import RETRY_ERRORS, RETRY_STATUS, RateLimiter, retry_after_seconds
+from .transport import (
+    ConnectionPool,
+    StreamingResponse,
+    TransportResponse,
+    raise_for_status,
+    shared_pool,
+)
+
+log = logging.getLogger(__name__)
+
+T = TypeVar("T")
 
 
 @dataclass
@@ -19,9 +38,213 @@ class ProviderResponse:
     tool_calls: list[ToolCall] = field(default_factory=list)
     input_tokens: int = 0
     output_tokens: int = 0
+    cache_read_tokens: int = 0      # prompt tokens served from the provider's prefix cache
+    cache_write_tokens: int = 0     # prompt tokens written to the cache (Anthropic only)
+    connect_seconds: float = 0.0    # TCP+TLS setup paid by this call (0 on a reused connection)
+    connection_reused: bool = False
+    ttft_seconds: float = 0.0       # request sent -> first streamed content (0 when not streamed)
+    generation_seconds: float = 0.0  # first streamed content -> end of stream
+
+
+# Called as soon as a streamed tool call's arguments are complete
+ToolCallCallback = Callable[[ToolCall], None]
+
+
+def parse_tool_input(raw: str | None) -> dict:
+    """A tool call's streamed JSON arguments; {} when they were cut off (e.g. at max_tokens)."""
+    try:
+        return json.loads(raw or "{}")
+    except json.JSONDecodeError:
+        return {}
+
+
+def _json(value: Any) -> bytes:
+    return json.dumps(value).encode("utf-8")
+
+
+class MessageEncoder:
+    """A conversation's messages converted to a provider's format and JSON-encoded once each.
+
+    The agent loop only appends to its message list, so each turn converts
+    and encodes just the new messages; encode() joins the cached pieces into
+    the JSON array. Entries are reused while the list still starts with the
+    same message objects; from the first one that differs, the rest is redone.
+    """
+
+    def __init__(self, convert: Callable[[dict], list[dict]]):
+        self._convert = convert
+        self._sources: list[dict] = []
+        self._encoded: list[bytes] = []   # per source message: its converted messages, comma-joined
+
+    def encode(self, messages: list[dict], lead: Iterable[dict] = (), tail: Iterable[dict] = ()) -> list[bytes]:
+        """Pieces of the JSON array of `lead` (encoded as is), the converted `messages`, then
+        `tail` (as is); left unjoined so the request body is assembled in one copy."""
+        keep = 0
+        for cached, message in zip(self._sources, messages):
+            if cached is not message:
+                break
+            keep += 1
+        del self._sources[keep:], self._encoded[keep:]
+        for message in messages[keep:]:
+            self._sources.append(message)
+            self._encoded.append(b",".join(_json(m) for m in self._convert(message)))
+        items = [_json(m) for m in lead] + [e for e in self._encoded if e] + [_json(m) for m in tail]
+        pieces = [b"["]
+        for item in items:
+            pieces += (item, b",")
+        if items:
+            pieces[-1] = b"]"   # over the trailing comma
+        else:
+            pieces.append(b"]")
+        return pieces
 
 
 class AgentProvider(ABC):
+    request_timeout: float = 300
+    supports_streaming: bool = False
+    # Shared limiter set by the runner; without one, requests are sent once
+    limiter: RateLimiter | None = None
+    throttle_seconds: float = 0.0   # waited on the limiter or backing off, this provider instance
+    sent_at: float = 0.0            # monotonic time the last request attempt was sent
+    retries: int = 0
+    # Prompt tokens the model accepts, and the ratio estimate_tokens assumes
+    context_window: int = 128_000
+    chars_per_token: float = 4.0
+
+    @property
+    def transport(self) -> ConnectionPool:
+        return shared_pool()
+
+    @property
+    def timer(self) -> PhaseTimer:
+        """serialize / throttle / http samples of this provider instance (one per task)."""
+        timer = self.__dict__.get("_timer")
+        if timer is None:
+            timer = self.__dict__["_timer"] = PhaseTimer()
+        return timer
+
+    def estimate_tokens(self, text: str) -> int:
+        """Fast token count for sizing a prompt before it is sent (no tokenizer round trip).
+
+        Used by the token-budgeted agent loop, which re-anchors its running
+        estimate on the provider's reported input_tokens after every turn, so
+        the error stays within one turn's additions.
+        """
+        return int(len(text) / self.chars_per_token) + 1
+
+    def _encode(self, body: dict, encoded: dict[str, Callable[[], bytes | list[bytes]]] | None = None) -> bytes:
+        """The JSON request body; `encoded` fields produce their own JSON (whole or in pieces),
+        which is spliced in while the body is joined."""
+        with self.timer.phase("serialize"):
+            data = _json(body)
+            if not encoded:
+                return data
+            pieces = [data[:-1]]
+            for key, make in encoded.items():
+                value = make()
+                if len(pieces) > 1 or body:
+                    pieces.append(b",")
+                pieces += (_json(key), b":")
+                pieces += [value] if isinstance(value, bytes) else value
+            pieces.append(b"}")
+            return b"".join(pieces)
+
+    def _message_encoder(self, convert: Callable[[dict], list[dict]]) -> MessageEncoder:
+        """This provider instance's (one per task) message cache."""
+        encoder = self.__dict__.get("_messages")
+        if encoder is None:
+            encoder = self.__dict__["_messages"] = MessageEncoder(convert)
+        return encoder
+
+    def _tools_json(self, tools: list[dict], convert: Callable[[list[dict]], Any]) -> bytes:
+        """convert(tools) as JSON, computed once for the tool list the agent loop passes every turn."""
+        cached = self.__dict__.get("_tools")
+        if cached is None or cached[0] is not tools:
+            cached = self.__dict__["_tools"] = (tools, _json(convert(tools)))
+        return cached[1]
+
+    def _post(self, url: str, data: bytes, headers: dict[str, str]) -> TransportResponse:
+        """POST over the shared keep-alive pool; raises urllib.error.HTTPError on 4xx/5xx."""
+        def send() -> TransportResponse:
+            resp = self.transport.request("POST", url, body=data, headers=headers, timeout=self.request_timeout)
+            raise_for_status(url, resp)
+            return resp
+        return self._with_retries(send, data)
+
+    def _post_stream(self, url: str, data: bytes, headers: dict[str, str]) -> StreamingResponse:
+        """Streaming POST over the shared pool; raises urllib.error.HTTPError on 4xx/5xx."""
+        return self._with_retries(
+            lambda: self.transport.stream("POST", url, body=data, headers=headers, timeout=self.request_timeout),
+            data,
+        )
+
+    def _with_retries(self, send: Callable[[], T], data: bytes) -> T:
+        """Send through the rate limiter, retrying 429s, transient 5xx and network errors.
+
+        Only failures before a response body arrives are retried; an error
+        partway through a stream still ends the call. The request size stands
+        in for its token count (~4 bytes per token). "http" samples run to the
+        full response, or to its headers for a stream. `sent_at` is set as
+        each attempt goes out, so after a success it excludes the throttling.
+        """
+        limiter = self.limiter
+        if limiter is None:
+            self.sent_at = time.monotonic()
+            with self.timer.phase("http"):
+                return send()
+        attempt = 0
+        while True:
+            waited = limiter.acquire(len(data) // 4)
+            if waited:
+                self.throttle_seconds += waited
+                self.timer.add("throttle", waited)
+            self.sent_at = time.monotonic()
+            try:
+                with self.timer.phase("http"):
+                    result = send()
+            except urllib.error.HTTPError as e:
+                if e.code not in RETRY_STATUS or attempt >= limiter.max_retries:
+                    raise
+                delay = limiter.backoff(attempt, retry_after_seconds(e.headers), throttled=e.code == 429)
+                reason = f"HTTP {e.code}"
+            except RETRY_ERRORS as e:
+                if attempt >= limiter.max_retries:
+                    raise
+                delay = limiter.backoff(attempt, None, throttled=False)
+                reason = type(e).__name__
+            else:
+                limiter.on_success()
+                return result
+            attempt += 1
+            self.retries += 1
+            log.warning("%s from %s; retry %d/%d%s", reason, type(self).__name__, attempt,
+                        limiter.max_retries, f" in {delay:.1f}s" if delay else " after shared pause")
+            if delay:
+                time.sleep(delay)
+                self.throttle_seconds += delay
+                self.timer.add("throttle", delay)
+
+    def stream_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+        on_tool_call: ToolCallCallback | None = None,
+    ) -> ProviderResponse:
+        """Streaming variant of create_message.
+
+        Providers that support SSE override this and invoke `on_tool_call` for
+        each tool call the moment its input is complete, while the model is
+        still generating. This fallback makes one blocking call and delivers the
+        tool calls afterwards.
+        """
+        response = self.create_message(system, messages, tools, max_tokens)
+        if on_tool_call is not None:
+            for tc in response.tool_calls:
+                on_tool_call(tc)
+        return response
+
     @abstractmethod
     def create_message(
         self,
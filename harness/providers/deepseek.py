@@ -6,8 +6,8 @@ DEEPSEEK_BASE_URL = "https://api.deepseek.com"
 
 
 class DeepSeekProvider(OpenAIProvider):
-    def __init__(self, api_key: str, model: str):
-        super().__init__(api_key=api_key, model=model, base_url=DEEPSEEK_BASE_URL)
+    def __init__(self, api_key: str, model: str, prompt_caching: bool = True):
+        super().__init__(api_key=api_key, model=model, base_url=DEEPSEEK_BASE_URL, prompt_caching=prompt_caching)
 
     def _token_param(self) -> str:
         return "max_tokens"
@@ -2,9 +2,11 @@ from __future__ import annotations
 
 import json
 import logging
-import urllib.request
+import time
+import urllib.error
 
-from .base import AgentProvider, ProviderResponse, ToolCall
+from .base import AgentProvider, ProviderResponse, ToolCall, ToolCallCallback
+from .transport import iter_sse
 from ..tools import schemas_to_gemini_declarations
 
 log = logging.getLogger(__name__)
@@ -13,34 +15,69 @@ API_URL = "https://generativelanguage.googleapis.com/v1beta/models"
 
 
 class GeminiProvider(AgentProvider):
+    supports_streaming = True
+    context_window = 1_048_576
+
     def __init__(self, api_key: str, model: str):
         self.api_key = api_key
         self.model = model
 
-    def create_message(
+    def _request_body(
         self,
         system: str,
         messages: list[dict],
         tools: list[dict],
-        max_tokens: int = 4096,
-    ) -> ProviderResponse:
-        declarations = schemas_to_gemini_declarations(tools)
-
+        max_tokens: int,
+    ) -> bytes:
+        """Encoded request body; contents are converted and encoded once per
+        conversation and the declarations once per task (see MessageEncoder)."""
         body = {
             "system_instruction": {"parts": [{"text": system}]},
-            "contents": self._convert_messages(messages),
-            "tools": [{"function_declarations": declarations}],
             "generationConfig": {"maxOutputTokens": max_tokens},
         }
+        encoder = self._message_encoder(self._convert_message)
+        return self._encode(body, {
+            "contents": lambda: encoder.encode(messages),
+            "tools": lambda: self._tools_json(
+                tools, lambda t: [{"function_declarations": schemas_to_gemini_declarations(t)}],
+            ),
+        })
+
+    @staticmethod
+    def _tool_call(part: dict, index: int) -> ToolCall:
+        fc = part["functionCall"]
+        meta = {}
+        if "thoughtSignature" in part:
+            meta["thoughtSignature"] = part["thoughtSignature"]
+        return ToolCall(
+            id=f"gemini_{fc['name']}_{index}",
+            name=fc["name"],
+            input=fc.get("args", {}),
+            metadata=meta,
+        )
+
+    @staticmethod
+    def _stop_reason(tool_calls: list[ToolCall], finish_reason: str | None) -> str:
+        if tool_calls:
+            return "tool_use"
+        elif finish_reason == "MAX_TOKENS":
+            return "max_tokens"
+        return "end_turn"
 
+    def create_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+    ) -> ProviderResponse:
         url = f"{API_URL}/{self.model}:generateContent?key={self.api_key}"
         headers = {"Content-Type": "application/json"}
-        data = json.dumps(body).encode("utf-8")
-        req = urllib.request.Request(url, data=data, headers=headers, method="POST")
+        data = self._request_body(system, messages, tools, max_tokens)
 
         try:
-            with urllib.request.urlopen(req, timeout=300) as resp:
-                result = json.loads(resp.read().decode("utf-8"))
+            resp = self._post(url, data, headers)
+            result = json.loads(resp.body.decode("utf-8"))
         except urllib.error.HTTPError as e:
             error_body = e.read().decode("utf-8", errors="replace")
             log.error("Gemini API error %s: %s", e.code, error_body)
@@ -52,92 +89,140 @@ class GeminiProvider(AgentProvider):
 
         for part in candidate.get("content", {}).get("parts", []):
             if "functionCall" in part:
-                fc = part["functionCall"]
-                meta = {}
-                if "thoughtSignature" in part:
-                    meta["thoughtSignature"] = part["thoughtSignature"]
-                tool_calls.append(
-                    ToolCall(
-                        id=f"gemini_{fc['name']}_{len(tool_calls)}",
-                        name=fc["name"],
-                        input=fc.get("args", {}),
-                        metadata=meta,
-                    )
-                )
+                tool_calls.append(self._tool_call(part, len(tool_calls)))
             elif "text" in part:
                 text_parts.append(part["text"])
 
-        stop_reason = "end_turn"
-        if tool_calls:
-            stop_reason = "tool_use"
-        elif candidate.get("finishReason") == "MAX_TOKENS":
-            stop_reason = "max_tokens"
-
         usage = result.get("usageMetadata", {})
         input_tokens = usage.get("promptTokenCount", 0)
         output_tokens = usage.get("candidatesTokenCount", 0)
 
         return ProviderResponse(
-            stop_reason=stop_reason,
+            stop_reason=self._stop_reason(tool_calls, candidate.get("finishReason")),
             text_content="\n".join(text_parts),
             tool_calls=tool_calls,
             input_tokens=input_tokens,
             output_tokens=output_tokens,
+            # Implicit context caching; already included in promptTokenCount
+            cache_read_tokens=usage.get("cachedContentTokenCount", 0),
+            connect_seconds=resp.connect_seconds,
+            connection_reused=resp.reused,
         )
 
-    def _convert_messages(self, messages: list[dict]) -> list[dict]:
-        gemini_msgs = []
-
-        for msg in messages:
-            role = msg["role"]
-            content = msg["content"]
-
-            if role == "user":
-                parts = []
-                if isinstance(content, str):
-                    parts.append({"text": content})
-                else:
-                    for block in content:
-                        if isinstance(block, str):
-                            parts.append({"text": block})
-                        elif isinstance(block, dict):
-                            if block.get("type") == "text":
-                                parts.append({"text": block.get("text", "")})
-                            elif block.get("type") == "tool_result":
-                                result_content = block.get("content", "")
-                                if isinstance(result_content, list):
-                                    result_content = "\n".join(
-                                        b.get("text", "") for b in result_content
-                                        if isinstance(b, dict)
-                                    )
-                                parts.append({
-                                    "functionResponse": {
-                                        "name": block.get("tool_name", "unknown"),
-                                        "response": {"result": str(result_content)},
-                                    }
-                                })
-                gemini_msgs.append({"role": "user", "parts": parts or [{"text": ""}]})
-
-            elif role == "assistant":
-                parts = []
-                if isinstance(content, str):
-                    parts.append({"text": content})
-                else:
-                    for block in content:
-                        if isinstance(block, dict):
-                            if block.get("type") == "text":
-                                parts.append({"text": block.get("text", "")})
-                            elif block.get("type") == "tool_use":
-                                fc_part = {
-                                    "functionCall": {
-                                        "name": block["name"],
-                                        "args": block.get("input", {}),
-                                    }
-                                }
-                                sig = block.get("metadata", {}).get("thoughtSignature")
-                                if sig:
-                                    fc_part["thoughtSignature"] = sig
-                                parts.append(fc_part)
-                gemini_msgs.append({"role": "model", "parts": parts or [{"text": ""}]})
+    def stream_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+        on_tool_call: ToolCallCallback | None = None,
+    ) -> ProviderResponse:
+        url = f"{API_URL}/{self.model}:streamGenerateContent?alt=sse&key={self.api_key}"
+        headers = {"Content-Type": "application/json"}
+        data = self._request_body(system, messages, tools, max_tokens)
+
+        try:
+            stream = self._post_stream(url, data, headers)
+        except urllib.error.HTTPError as e:
+            error_body = e.read().decode("utf-8", errors="replace")
+            log.error("Gemini API error %s: %s", e.code, error_body)
+            raise
+        sent = self.sent_at   # the attempt that succeeded, after any throttling
+
+        # Each SSE chunk is a partial GenerateContentResponse. Text arrives in
+        # pieces but functionCall parts are always whole, so they can be
+        # dispatched as soon as their chunk lands.
+        text_parts: list[str] = []
+        tool_calls: list[ToolCall] = []
+        usage: dict = {}
+        finish_reason = None
+        first_content: float | None = None
+
+        with stream:
+            for _, payload in iter_sse(stream.iter_lines()):
+                chunk = json.loads(payload)
+                if "error" in chunk:
+                    raise RuntimeError(f"Gemini stream error: {chunk['error'].get('message', payload)}")
+                if chunk.get("usageMetadata"):
+                    usage = chunk["usageMetadata"]
+                for candidate in chunk.get("candidates", [])[:1]:
+                    if candidate.get("finishReason"):
+                        finish_reason = candidate["finishReason"]
+                    for part in candidate.get("content", {}).get("parts", []):
+                        if first_content is None:
+                            first_content = time.monotonic()
+                        if "functionCall" in part:
+                            tc = self._tool_call(part, len(tool_calls))
+                            tool_calls.append(tc)
+                            if on_tool_call is not None:
+                                on_tool_call(tc)
+                        elif "text" in part:
+                            text_parts.append(part["text"])
+        done = time.monotonic()
 
-        return gemini_msgs
+        return ProviderResponse(
+            stop_reason=self._stop_reason(tool_calls, finish_reason),
+            text_content="".join(text_parts),
+            tool_calls=tool_calls,
+            input_tokens=usage.get("promptTokenCount", 0),
+            output_tokens=usage.get("candidatesTokenCount", 0),
+            cache_read_tokens=usage.get("cachedContentTokenCount", 0),
+            connect_seconds=stream.connect_seconds,
+            connection_reused=stream.reused,
+            ttft_seconds=(first_content or done) - sent,
+            generation_seconds=done - (first_content or done),
+        )
+
+    def _convert_message(self, msg: dict) -> list[dict]:
+        role = msg["role"]
+        content = msg["content"]
+
+        if role == "user":
+            parts = []
+            if isinstance(content, str):
+                parts.append({"text": content})
+            else:
+                for block in content:
+                    if isinstance(block, str):
+                        parts.append({"text": block})
+                    elif isinstance(block, dict):
+                        if block.get("type") == "text":
+                            parts.append({"text": block.get("text", "")})
+                        elif block.get("type") == "tool_result":
+                            result_content = block.get("content", "")
+                            if isinstance(result_content, list):
+                                result_content = "\n".join(
+                                    b.get("text", "") for b in result_content
+                                    if isinstance(b, dict)
+                                )
+                            parts.append({
+                                "functionResponse": {
+                                    "name": block.get("tool_name", "unknown"),
+                                    "response": {"result": str(result_content)},
+                                }
+                            })
+            return [{"role": "user", "parts": parts or [{"text": ""}]}]
+
+        if role == "assistant":
+            parts = []
+            if isinstance(content, str):
+                parts.append({"text": content})
+            else:
+                for block in content:
+                    if isinstance(block, dict):
+                        if block.get("type") == "text":
+                            parts.append({"text": block.get("text", "")})
+                        elif block.get("type") == "tool_use":
+                            fc_part = {
+                                "functionCall": {
+                                    "name": block["name"],
+                                    "args": block.get("input", {}),
+                                }
+                            }
+                            sig = block.get("metadata", {}).get("thoughtSignature")
+                            if sig:
+                                fc_part["thoughtSignature"] = sig
+                            parts.append(fc_part)
+            return [{"role": "model", "parts": parts or [{"text": ""}]}]
+
+        return []
@@ -1,10 +1,13 @@
 from __future__ import annotations
 
+import hashlib
 import json
 import logging
-import urllib.request
+import time
+import urllib.error
 
-from .base import AgentProvider, ProviderResponse, ToolCall
+from .base import AgentProvider, ProviderResponse, ToolCall, ToolCallCallback, parse_tool_input
+from .transport import iter_sse
 from ..tools import schemas_to_openai
 
 log = logging.getLogger(__name__)
@@ -13,12 +16,39 @@ DEFAULT_BASE_URL = "https://api.openai.com/v1"
 
 
 class OpenAIProvider(AgentProvider):
-    def __init__(self, api_key: str, model: str, base_url: str | None = None, is_bedrock_anthropic: bool = False, custom_headers: dict[str, str] | None = None):
+    supports_streaming = True
+
+    def __init__(self, api_key: str, model: str, base_url: str | None = None, is_bedrock_anthropic: bool = False, custom_headers: dict[str, str] | None = None, prompt_caching: bool = True):
         self.api_key = api_key
         self.model = model
         self.base_url = (base_url or DEFAULT_BASE_URL).rstrip("/")
         self.is_bedrock_anthropic = is_bedrock_anthropic
         self.custom_headers = custom_headers or {}
+        self.prompt_caching = prompt_caching
+
+    def _cache_params(self, system: str, tools: list[dict]) -> dict:
+        """Extra body fields for prefix caching.
+
+        OpenAI caches prompt prefixes automatically; `prompt_cache_key` routes
+        requests sharing a prefix (same system prompt + tools) to the same cache
+        shard. Only sent to api.openai.com, since other compatible servers may
+        reject unknown fields.
+        """
+        if not self.prompt_caching or self.base_url != DEFAULT_BASE_URL:
+            return {}
+        digest = hashlib.sha256(
+            json.dumps([system, [t["name"] for t in tools]]).encode("utf-8")
+        ).hexdigest()[:32]
+        return {"prompt_cache_key": f"agentre-{digest}"}
+
+    @staticmethod
+    def _cache_usage(usage: dict) -> tuple[int, int]:
+        """(cache_read, cache_write) tokens from an OpenAI-style usage block."""
+        details = usage.get("prompt_tokens_details") or {}
+        cache_read = details.get("cached_tokens") or 0
+        # DeepSeek reports its disk cache separately
+        cache_read = cache_read or usage.get("prompt_cache_hit_tokens", 0) or 0
+        return cache_read, 0
 
     def _token_param(self) -> str:
         """Parameter name for max output tokens. Override for API compatibility."""
@@ -35,53 +65,79 @@ class OpenAIProvider(AgentProvider):
                 headers[key] = value
         return headers
 
-    def create_message(
+    def _request_data(
         self,
         system: str,
         messages: list[dict],
         tools: list[dict],
-        max_tokens: int = 4096,
-    ) -> ProviderResponse:
-        openai_tools = schemas_to_openai(tools)
-
-        oai_messages = [{"role": "system", "content": system}]
-        for msg in messages:
-            oai_messages.extend(self._convert_message(msg))
-
+        max_tokens: int,
+        **extra,
+    ) -> bytes:
+        """Encoded request body. Messages are converted and encoded once per
+        conversation and the tool list once per task; see MessageEncoder."""
         body = {
             "model": self.model,
-            "messages": oai_messages,
-            "tools": openai_tools,
             "tool_choice": "auto",  # Allow model to choose when to use tools
             self._token_param(): max_tokens,
+            **self._cache_params(system, tools),
+            **extra,
         }
+        encoder = self._message_encoder(self._convert_message)
+        return self._encode(body, {
+            "messages": lambda: encoder.encode(messages, lead=[{"role": "system", "content": system}]),
+            "tools": lambda: self._tools_json(tools, schemas_to_openai),
+        })
 
-        headers = self._request_headers()
+    def _api_error(self, e: urllib.error.HTTPError) -> RuntimeError:
+        error_body = e.read().decode("utf-8", errors="replace")
+        log.error("OpenAI-compatible API error %d: %s", e.code, error_body)
+        # Try to parse error JSON for better error message
+        try:
+            error_json = json.loads(error_body)
+            if "errors" in error_json:
+                # CS GenAI Hub format
+                error_msg = error_json["errors"][0].get("message", error_body)
+            elif "error" in error_json:
+                # Standard OpenAI format
+                error_msg = error_json["error"].get("message", error_body)
+            else:
+                error_msg = error_body
+            return RuntimeError(f"HTTP {e.code}: {error_msg}")
+        except (json.JSONDecodeError, KeyError, IndexError, AttributeError):
+            return RuntimeError(f"HTTP {e.code}: {error_body}")
 
-        data = json.dumps(body).encode("utf-8")
+    def _stop_reason(self, finish_reason: str | None, has_tool_calls: bool) -> str:
+        if self.is_bedrock_anthropic:
+            # Bedrock/Anthropic mode: endpoint returns "stop" even with tool_calls
+            # Check for tool presence first
+            if has_tool_calls:
+                return "tool_use"
+            elif finish_reason == "length":
+                return "max_tokens"
+            return "end_turn"
+        # Standard OpenAI mode: check finish_reason
+        if finish_reason == "tool_calls":
+            return "tool_use"
+        elif finish_reason == "length":
+            return "max_tokens"
+        return "end_turn"
+
+    def create_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+    ) -> ProviderResponse:
+        data = self._request_data(system, messages, tools, max_tokens)
+        headers = self._request_headers()
         url = f"{self.base_url}/chat/completions"
-        req = urllib.request.Request(url, data=data, headers=headers, method="POST")
 
         try:
-            with urllib.request.urlopen(req, timeout=300) as resp:
-                result = json.loads(resp.read().decode("utf-8"))
+            resp = self._post(url, data, headers)
+            result = json.loads(resp.body.decode("utf-8"))
         except urllib.error.HTTPError as e:
-            error_body = e.read().decode("utf-8", errors="replace")
-            log.error("OpenAI-compatible API error %d: %s", e.code, error_body)
-            # Try to parse error JSON for better error message
-            try:
-                error_json = json.loads(error_body)
-                if "errors" in error_json:
-                    # CS GenAI Hub format
-                    error_msg = error_json["errors"][0].get("message", error_body)
-                elif "error" in error_json:
-                    # Standard OpenAI format
-                    error_msg = error_json["error"].get("message", error_body)
-                else:
-                    error_msg = error_body
-                raise RuntimeError(f"HTTP {e.code}: {error_msg}")
-            except (json.JSONDecodeError, KeyError, IndexError):
-                raise RuntimeError(f"HTTP {e.code}: {error_body}")
+            raise self._api_error(e)
 
         choice = result["choices"][0]
         message = choice["message"]
@@ -96,26 +152,10 @@ class OpenAIProvider(AgentProvider):
                 ToolCall(id=tc["id"], name=tc["function"]["name"], input=args)
             )
 
-        # Determine stop reason
-        if self.is_bedrock_anthropic:
-            # Bedrock/Anthropic mode: endpoint returns "stop" even with tool_calls
-            # Check for tool presence first
-            if tool_calls:
-                stop_reason = "tool_use"
-            elif choice.get("finish_reason") == "length":
-                stop_reason = "max_tokens"
-            else:
-                stop_reason = "end_turn"
-        else:
-            # Standard OpenAI mode: check finish_reason
-            if choice.get("finish_reason") == "tool_calls":
-                stop_reason = "tool_use"
-            elif choice.get("finish_reason") == "length":
-                stop_reason = "max_tokens"
-            else:
-                stop_reason = "end_turn"
+        stop_reason = self._stop_reason(choice.get("finish_reason"), bool(tool_calls))
 
         usage = result.get("usage", {})
+        cache_read, cache_write = self._cache_usage(usage)
 
         return ProviderResponse(
             stop_reason=stop_reason,
@@ -123,6 +163,110 @@ class OpenAIProvider(AgentProvider):
             tool_calls=tool_calls,
             input_tokens=usage.get("prompt_tokens", 0),
             output_tokens=usage.get("completion_tokens", 0),
+            cache_read_tokens=cache_read,
+            cache_write_tokens=cache_write,
+            connect_seconds=resp.connect_seconds,
+            connection_reused=resp.reused,
+        )
+
+    def stream_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+        on_tool_call: ToolCallCallback | None = None,
+    ) -> ProviderResponse:
+        data = self._request_data(
+            system, messages, tools, max_tokens,
+            stream=True, stream_options={"include_usage": True},
+        )
+        headers = self._request_headers()
+        url = f"{self.base_url}/chat/completions"
+
+        try:
+            stream = self._post_stream(url, data, headers)
+        except urllib.error.HTTPError as e:
+            raise self._api_error(e)
+        sent = self.sent_at   # the attempt that succeeded, after any throttling
+
+        text_parts: list[str] = []
+        calls: dict[int, dict] = {}   # index -> {"id", "name", "args": [...]}
+        delivered: set[int] = set()
+        usage: dict = {}
+        finish_reason = None
+        first_content: float | None = None
+
+        def deliver(index: int) -> None:
+            # Tool calls stream one after another, so a call is complete as
+            # soon as the next index starts (or the stream finishes).
+            if index in delivered or on_tool_call is None:
+                return
+            delivered.add(index)
+            c = calls[index]
+            on_tool_call(ToolCall(id=c["id"], name=c["name"], input=parse_tool_input("".join(c["args"]))))
+
+        with stream:
+            for _, payload in iter_sse(stream.iter_lines()):
+                if payload.strip() == "[DONE]":
+                    # Keep reading to EOF so the connection can be reused
+                    continue
+                chunk = json.loads(payload)
+                if "error" in chunk:
+                    err = chunk["error"]
+                    msg = err.get("message", payload) if isinstance(err, dict) else str(err)
+                    raise RuntimeError(f"OpenAI-compatible stream error: {msg}")
+                if chunk.get("usage"):
+                    usage = chunk["usage"]
+                for choice in chunk.get("choices") or []:
+                    delta = choice.get("delta") or {}
+                    if delta.get("content"):
+                        if first_content is None:
+                            first_content = time.monotonic()
+                        text_parts.append(delta["content"])
+                    for tc in delta.get("tool_calls") or []:
+                        if first_content is None:
+                            first_content = time.monotonic()
+                        index = tc.get("index", len(calls))
+                        if index not in calls:
+                            for prev in list(calls):
+                                deliver(prev)
+                            calls[index] = {"id": "", "name": "", "args": []}
+                        c = calls[index]
+                        if tc.get("id"):
+                            c["id"] = tc["id"]
+                        fn = tc.get("function") or {}
+                        if fn.get("name"):
+                            c["name"] += fn["name"]
+                        if fn.get("arguments"):
+                            c["args"].append(fn["arguments"])
+                    if choice.get("finish_reason"):
+                        finish_reason = choice["finish_reason"]
+                        for index in sorted(calls):
+                            deliver(index)
+        done = time.monotonic()
+
+        for index in sorted(calls):
+            deliver(index)
+
+        tool_calls = [
+            ToolCall(id=c["id"], name=c["name"], input=parse_tool_input("".join(c["args"])))
+            for _, c in sorted(calls.items())
+        ]
+        cache_read, cache_write = self._cache_usage(usage)
+
+        return ProviderResponse(
+            stop_reason=self._stop_reason(finish_reason, bool(tool_calls)),
+            text_content="".join(text_parts),
+            tool_calls=tool_calls,
+            input_tokens=usage.get("prompt_tokens", 0),
+            output_tokens=usage.get("completion_tokens", 0),
+            cache_read_tokens=cache_read,
+            cache_write_tokens=cache_write,
+            connect_seconds=stream.connect_seconds,
+            connection_reused=stream.reused,
+            ttft_seconds=(first_content or done) - sent,
+            generation_seconds=done - (first_content or done),
         )
 
     def _convert_message(self, msg: dict) -> list[dict]:
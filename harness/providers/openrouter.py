@@ -7,8 +7,8 @@ DEFAULT_BASE_URL = "https://openrouter.ai/api/v1"
 
 
 class OpenRouterProvider(OpenAIProvider):
-    def __init__(self, api_key: str, model: str):
-        super().__init__(api_key=api_key, model=model, base_url=DEFAULT_BASE_URL)
+    def __init__(self, api_key: str, model: str, prompt_caching: bool = True):
+        super().__init__(api_key=api_key, model=model, base_url=DEFAULT_BASE_URL, prompt_caching=prompt_caching)
 
     def _request_headers(self) -> dict[str, str]:
         headers = super()._request_headers()
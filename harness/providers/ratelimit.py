@@ -0,0 +1,172 @@
+from __future__ import annotations
+
+import email.utils
+import http.client
+import logging
+import random
+import threading
+import time
+import urllib.error
+from collections import deque
+from email.message import Message
+
+log = logging.getLogger(__name__)
+
+# Worth retrying: rate limited, overloaded, or a transient server/gateway error
+RETRY_STATUS = {408, 425, 429, 500, 502, 503, 504, 529}
+RETRY_ERRORS = (
+    ConnectionError,
+    TimeoutError,
+    http.client.RemoteDisconnected,
+    http.client.IncompleteRead,
+    urllib.error.URLError,
+)
+
+WINDOW_SECONDS = 60.0
+# Fewer requests than this in the window say little about the real limit
+MIN_LEARN_REQUESTS = 10
+
+
+def retry_after_seconds(headers: Message | None) -> float | None:
+    """Delay requested by `retry-after-ms` / `retry-after` (seconds or HTTP date)."""
+    if headers is None:
+        return None
+    value = headers.get("retry-after-ms")
+    if value:
+        try:
+            return max(0.0, float(value) / 1000)
+        except ValueError:
+            pass
+    value = headers.get("retry-after")
+    if not value:
+        return None
+    try:
+        return max(0.0, float(value))
+    except ValueError:
+        pass
+    try:
+        when = email.utils.parsedate_to_datetime(value)
+    except (TypeError, ValueError):
+        return None
+    return max(0.0, when.timestamp() - time.time())
+
+
+class RateLimiter:
+    """Requests/tokens-per-minute budget shared by every task using a provider.
+
+    `acquire` blocks until a request fits the sliding one-minute window. A 429
+    pauses all callers until its `retry-after`, so concurrent tasks do not
+    retry in lockstep. It also lowers a learned request rate to 70% of what
+    the window held when the limit hit, which then creeps back up by about
+    one request per minute per minute of successes (AIMD). Budgets of 0 are
+    unlimited until the provider pushes back.
+    """
+
+    def __init__(
+        self,
+        requests_per_minute: int = 0,
+        tokens_per_minute: int = 0,
+        max_retries: int = 5,
+        base_delay: float = 1.0,
+        max_delay: float = 60.0,
+    ):
+        self.requests_per_minute = requests_per_minute
+        self.tokens_per_minute = tokens_per_minute
+        self.max_retries = max_retries
+        self.base_delay = base_delay
+        self.max_delay = max_delay
+        self._window: deque[tuple[float, int]] = deque()   # (sent_at, estimated tokens)
+        self._window_tokens = 0
+        self._blocked_until = 0.0
+        self._learned_rpm: float | None = None
+        self._lock = threading.Lock()
+        self.throttled = 0        # 429s seen
+
+    def _prune(self, now: float) -> None:
+        while self._window and now - self._window[0][0] >= WINDOW_SECONDS:
+            _, tokens = self._window.popleft()
+            self._window_tokens -= tokens
+
+    def _rpm(self) -> float:
+        limits = [l for l in (self.requests_per_minute, self._learned_rpm) if l]
+        return min(limits) if limits else 0
+
+    def _wait_for(self, now: float, tokens: int) -> float:
+        wait = self._blocked_until - now
+        rpm = self._rpm()
+        if rpm and len(self._window) >= rpm:
+            # Oldest requests must age out until one more fits
+            index = len(self._window) - int(rpm)
+            wait = max(wait, self._window[index][0] + WINDOW_SECONDS - now)
+        if self.tokens_per_minute and self._window:
+            excess = self._window_tokens + tokens - self.tokens_per_minute
+            for sent_at, used in self._window:
+                if excess <= 0:
+                    break
+                excess -= used
+                wait = max(wait, sent_at + WINDOW_SECONDS - now)
+        return wait
+
+    def acquire(self, tokens: int = 0) -> float:
+        """Block until a request of ~`tokens` fits the budget; returns seconds waited."""
+        if self.tokens_per_minute:
+            tokens = min(tokens, self.tokens_per_minute)   # an oversized request still goes, alone
+        waited = 0.0
+        while True:
+            with self._lock:
+                now = time.monotonic()
+                self._prune(now)
+                wait = self._wait_for(now, tokens)
+                if wait <= 0:
+                    self._window.append((now, tokens))
+                    self._window_tokens += tokens
+                    return waited
+            wait = min(wait, self.max_delay)
+            time.sleep(wait)
+            waited += wait
+
+    def backoff(self, attempt: int, retry_after: float | None, throttled: bool) -> float:
+        """Delay before retry `attempt` (0-based), with full jitter.
+
+        For a 429 the delay becomes a shared pause applied through `acquire`,
+        and 0 is returned; other failures back off only the caller.
+        """
+        delay = retry_after
+        if delay is None:
+            delay = random.uniform(0, min(self.max_delay, self.base_delay * (2 ** attempt)))
+        delay = min(delay, self.max_delay)
+        if not throttled:
+            return delay
+        with self._lock:
+            now = time.monotonic()
+            self.throttled += 1
+            self._blocked_until = max(self._blocked_until, now + delay)
+            self._prune(now)
+            if len(self._window) >= MIN_LEARN_REQUESTS:
+                observed = len(self._window) * 0.7
+                self._learned_rpm = min(self._learned_rpm or observed, observed)
+        return 0.0
+
+    def on_success(self) -> None:
+        with self._lock:
+            if self._learned_rpm is not None:
+                self._learned_rpm += 1.0 / max(self._learned_rpm, 1.0)
+
+
+_limiters: dict[str, RateLimiter] = {}
+_limiters_lock = threading.Lock()
+
+
+def rate_limiter(
+    key: str,
+    requests_per_minute: int = 0,
+    tokens_per_minute: int = 0,
+    max_retries: int = 5,
+) -> RateLimiter:
+    """Process-wide limiter for one provider (e.g. "anthropic"), created on first use."""
+    with _limiters_lock:
+        limiter = _limiters.get(key)
+        if limiter is None:
+            limiter = RateLimiter(requests_per_minute, tokens_per_minute, max_retries)
+            _limiters[key] = limiter
+        return limiter
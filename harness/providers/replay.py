@@ -0,0 +1,110 @@
+from __future__ import annotations
+
+import logging
+import time
+from pathlib import Path
+from typing import Callable
+
+from ..transcript import find_transcript, read_transcript
+from .base import AgentProvider, ProviderResponse, ToolCall
+
+log = logging.getLogger(__name__)
+
+# Seconds a replayed turn waits, given the recorded step record
+LatencyModel = Callable[[dict], float]
+
+
+def parse_latency_model(spec: str) -> LatencyModel:
+    """"none" (full speed), "recorded" or "recorded*F" (each turn's recorded LLM time,
+    scaled by F), or a fixed number of seconds per turn."""
+    spec = spec.strip()
+    if spec == "none":
+        return lambda step: 0.0
+    if spec == "recorded" or spec.startswith("recorded*"):
+        scale = float(spec.partition("*")[2] or 1.0)
+        if scale < 0:
+            raise ValueError(f"Negative latency scale in {spec!r}")
+        return lambda step: step.get("llm_seconds", 0.0) * scale
+    try:
+        seconds = float(spec)
+    except ValueError:
+        raise ValueError(f"Expected none, recorded, recorded*F or seconds, got {spec!r}") from None
+    if seconds < 0:
+        raise ValueError(f"Negative latency {spec!r}")
+    return lambda step: seconds
+
+
+def recorded_turns(transcript: dict) -> list[tuple[dict | None, dict]]:
+    """(assistant message, its step record) per recorded model turn, in order.
+
+    A turn that added no message (max_tokens with no text) has None. Each
+    step record counts the messages before its turn; transcripts written
+    before it did are paired by position.
+    """
+    messages, steps = transcript["messages"], transcript["steps"]
+    if not steps or not all("messages" in step for step in steps):
+        assistant = [m for m in messages if m.get("role") == "assistant"]
+        return [(message, steps[i] if i < len(steps) else {}) for i, message in enumerate(assistant)]
+    turns = []
+    for step in steps:
+        index = step["messages"]
+        message = messages[index] if index < len(messages) else None
+        turns.append((message if message is not None and message.get("role") == "assistant" else None, step))
+    return turns
+
+
+class ReplayProvider(AgentProvider):
+    """Plays back the model turns of an earlier run's transcripts; no API calls.
+
+    `model` is that run's results directory (or its transcripts/ directory).
+    Turn N returns the recorded assistant message N, whatever the conversation
+    holds, so the same tool calls and final answer are issued against the
+    live ToolExecutor, with the recorded token counts. Turns are returned at
+    full speed unless a latency model says otherwise. An answer the recorded
+    run extracted from plain text is submitted as a final_answer call once
+    the turns run out; a call past that raises, as the recorded run ended
+    there too.
+    """
+
+    def __init__(self, api_key: str, model: str, task_id: str, latency: LatencyModel | None = None):
+        self.model = model
+        self.task_id = task_id
+        self.latency = latency or parse_latency_model("none")
+        root = Path(model)
+        path = find_transcript(root / "transcripts", task_id) or find_transcript(root, task_id)
+        if path is None:
+            raise FileNotFoundError(f"No recorded transcript for {task_id} under {root}")
+        transcript = read_transcript(path)
+        self.turns = recorded_turns(transcript)[::-1]   # popped from the end
+        self.final_answer = (transcript["summary"] or {}).get("final_answer")
+
+    def create_message(
+        self,
+        system: str,
+        messages: list[dict],
+        tools: list[dict],
+        max_tokens: int = 4096,
+    ) -> ProviderResponse:
+        if not self.turns and self.final_answer is not None:
+            answer, self.final_answer = self.final_answer, None
+            return ProviderResponse("tool_use", "", [ToolCall("replay_final", "final_answer", answer)])
+        if not self.turns:
+            raise RuntimeError(f"Recording of {self.task_id} has no more model turns")
+        message, step = self.turns.pop()
+        delay = self.latency(step)
+        if delay:
+            time.sleep(delay)
+
+        content = message.get("content") if message is not None else None
+        blocks = content if isinstance(content, list) else [{"type": "text", "text": content or ""}]
+        tool_calls = [
+            ToolCall(id=b["id"], name=b["name"], input=b.get("input", {}))
+            for b in blocks if b.get("type") == "tool_use"
+        ]
+        return ProviderResponse(
+            stop_reason=step.get("stop_reason") or ("tool_use" if tool_calls else "end_turn"),
+            text_content="".join(b.get("text", "") for b in blocks if b.get("type") == "text"),
+            tool_calls=tool_calls,
+            input_tokens=step.get("input_tokens", 0),
+            output_tokens=step.get("output_tokens", 0),
+        )
@@ -0,0 +1,304 @@
+from __future__ import annotations
+
+import http.client
+import io
+import logging
+import ssl
+import threading
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+from dataclasses import dataclass, field
+from email.message import Message
+from typing import Iterator
+
+log = logging.getLogger(__name__)
+
+# Errors that mean a pooled keep-alive connection was closed by the server
+# between requests; the request is retried once on a fresh connection.
+_STALE_ERRORS = (
+    http.client.RemoteDisconnected,
+    http.client.CannotSendRequest,
+    http.client.BadStatusLine,
+    BrokenPipeError,
+    ConnectionResetError,
+    ConnectionAbortedError,
+)
+
+
+@dataclass
+class TransportResponse:
+    status: int
+    reason: str
+    headers: Message
+    body: bytes
+    connect_seconds: float = 0.0   # TCP + TLS handshake paid by this request (0 if reused)
+    reused: bool = False
+
+
+class StreamingResponse:
+    """An open response whose body is consumed incrementally (e.g. SSE).
+
+    Use as a context manager; the connection goes back to the pool only if the
+    body was read to the end, otherwise it is closed.
+    """
+
+    def __init__(self, pool: "ConnectionPool", key: tuple[str, str, int],
+                 conn: http.client.HTTPConnection, resp: http.client.HTTPResponse,
+                 connect_seconds: float, reused: bool):
+        self._pool = pool
+        self._key = key
+        self._conn = conn
+        self._resp = resp
+        self.status = resp.status
+        self.reason = resp.reason
+        self.headers = resp.headers
+        self.connect_seconds = connect_seconds
+        self.reused = reused
+        self._done = False
+
+    def iter_lines(self) -> Iterator[str]:
+        while True:
+            line = self._resp.readline()
+            if not line:
+                self._done = True
+                return
+            yield line.decode("utf-8", errors="replace").rstrip("\r\n")
+
+    def close(self) -> None:
+        if self._conn is None:
+            return
+        if self._done and not self._resp.will_close:
+            # The connection refuses a new request until the old response is closed
+            self._resp.close()
+            self._pool._release(self._key, self._conn)
+        else:
+            self._conn.close()
+        self._conn = None
+
+    def __enter__(self) -> "StreamingResponse":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+
+def iter_sse(lines: Iterator[str]) -> Iterator[tuple[str, str]]:
+    """Parse Server-Sent Events into (event, data) pairs."""
+    event = ""
+    data: list[str] = []
+    for line in lines:
+        if not line:
+            if data:
+                yield event or "message", "\n".join(data)
+            event, data = "", []
+            continue
+        if line.startswith(":"):
+            continue
+        name, _, value = line.partition(":")
+        if value.startswith(" "):
+            value = value[1:]
+        if name == "event":
+            event = value
+        elif name == "data":
+            data.append(value)
+    if data:
+        yield event or "message", "\n".join(data)
+
+
+@dataclass
+class TransportStats:
+    requests: int = 0
+    connections_opened: int = 0
+    connections_reused: int = 0
+    connect_seconds: float = 0.0
+    by_host: dict[str, int] = field(default_factory=dict)
+
+
+class ConnectionPool:
+    """Thread-safe pool of persistent HTTP/1.1 keep-alive connections.
+
+    Connections are keyed by (scheme, host, port). A request takes an idle
+    connection or opens a new one, and returns it to the pool afterwards unless
+    the server asked to close. Proxies from the environment are honoured the
+    same way urllib does (CONNECT tunnel for https).
+
+    HTTP/2 would need a third-party client; the stdlib only speaks HTTP/1.1, so
+    concurrency comes from holding several connections per host instead.
+    """
+
+    def __init__(self, max_idle_per_host: int = 8):
+        self.max_idle_per_host = max_idle_per_host
+        self._idle: dict[tuple[str, str, int], list[http.client.HTTPConnection]] = {}
+        self._lock = threading.Lock()
+        self._ssl_context = ssl.create_default_context()
+        self.stats = TransportStats()
+
+    @staticmethod
+    def _proxy_for(scheme: str, host: str) -> str | None:
+        proxy = urllib.request.getproxies().get(scheme)
+        if proxy and urllib.request.proxy_bypass(host):
+            return None
+        return proxy
+
+    def _new_connection(self, scheme: str, host: str, port: int, timeout: float) -> http.client.HTTPConnection:
+        proxy = self._proxy_for(scheme, host)
+        if proxy:
+            parsed = urllib.parse.urlsplit(proxy if "://" in proxy else f"http://{proxy}")
+            proxy_host = parsed.hostname or ""
+            proxy_port = parsed.port or (443 if parsed.scheme == "https" else 80)
+            if scheme == "https":
+                conn: http.client.HTTPConnection = http.client.HTTPSConnection(
+                    proxy_host, proxy_port, timeout=timeout, context=self._ssl_context,
+                )
+                conn.set_tunnel(host, port)
+            else:
+                conn = http.client.HTTPConnection(proxy_host, proxy_port, timeout=timeout)
+            return conn
+
+        if scheme == "https":
+            return http.client.HTTPSConnection(host, port, timeout=timeout, context=self._ssl_context)
+        return http.client.HTTPConnection(host, port, timeout=timeout)
+
+    def _acquire(self, key: tuple[str, str, int], timeout: float) -> tuple[http.client.HTTPConnection, float, bool]:
+        with self._lock:
+            idle = self._idle.get(key)
+            if idle:
+                conn = idle.pop()
+                conn.timeout = timeout
+                if conn.sock is not None:
+                    conn.sock.settimeout(timeout)
+                self.stats.connections_reused += 1
+                return conn, 0.0, True
+
+        conn = self._new_connection(*key, timeout=timeout)
+        start = time.monotonic()
+        conn.connect()
+        elapsed = time.monotonic() - start
+        with self._lock:
+            self.stats.connections_opened += 1
+            self.stats.connect_seconds += elapsed
+        return conn, elapsed, False
+
+    def _release(self, key: tuple[str, str, int], conn: http.client.HTTPConnection) -> None:
+        with self._lock:
+            idle = self._idle.setdefault(key, [])
+            if len(idle) < self.max_idle_per_host:
+                idle.append(conn)
+                return
+        conn.close()
+
+    def request(
+        self,
+        method: str,
+        url: str,
+        body: bytes | None = None,
+        headers: dict[str, str] | None = None,
+        timeout: float = 300,
+    ) -> TransportResponse:
+        resp = self._send(method, url, body, headers, timeout, stream=False)
+        assert isinstance(resp, TransportResponse)
+        return resp
+
+    def stream(
+        self,
+        method: str,
+        url: str,
+        body: bytes | None = None,
+        headers: dict[str, str] | None = None,
+        timeout: float = 300,
+    ) -> StreamingResponse:
+        """Send a request and return once headers arrive; 4xx/5xx raise HTTPError."""
+        resp = self._send(method, url, body, headers, timeout, stream=True)
+        if isinstance(resp, TransportResponse):
+            raise_for_status(url, resp)
+            raise RuntimeError(f"HTTP {resp.status}: unexpected non-streaming response")
+        return resp
+
+    def _send(
+        self,
+        method: str,
+        url: str,
+        body: bytes | None,
+        headers: dict[str, str] | None,
+        timeout: float,
+        stream: bool,
+    ) -> TransportResponse | StreamingResponse:
+        parts = urllib.parse.urlsplit(url)
+        scheme = parts.scheme or "https"
+        port = parts.port or (443 if scheme == "https" else 80)
+        key = (scheme, parts.hostname or "", port)
+        path = parts.path or "/"
+        if parts.query:
+            path += "?" + parts.query
+
+        # Plain-http proxies take the absolute URL; https goes through a tunnel
+        target = url if scheme == "http" and self._proxy_for(scheme, key[1]) else path
+
+        with self._lock:
+            self.stats.requests += 1
+            self.stats.by_host[key[1]] = self.stats.by_host.get(key[1], 0) + 1
+
+        send_headers = {"Connection": "keep-alive", **(headers or {})}
+
+        for attempt in range(2):
+            conn, connect_seconds, reused = self._acquire(key, timeout)
+            try:
+                conn.request(method, target, body=body, headers=send_headers)
+                resp = conn.getresponse()
+                if stream and resp.status < 400:
+                    return StreamingResponse(self, key, conn, resp, connect_seconds, reused)
+                data = resp.read()
+            except _STALE_ERRORS:
+                conn.close()
+                if reused and attempt == 0:
+                    log.debug("Stale keep-alive connection to %s, reconnecting", key[1])
+                    continue
+                raise
+            except Exception:
+                conn.close()
+                raise
+
+            if resp.will_close:
+                conn.close()
+            else:
+                self._release(key, conn)
+
+            return TransportResponse(
+                status=resp.status,
+                reason=resp.reason,
+                headers=resp.headers,
+                body=data,
+                connect_seconds=connect_seconds,
+                reused=reused,
+            )
+
+        raise RuntimeError("unreachable")
+
+    def close(self) -> None:
+        with self._lock:
+            idle, self._idle = self._idle, {}
+        for conns in idle.values():
+            for conn in conns:
+                conn.close()
+
+
+_shared_pool: ConnectionPool | None = None
+_shared_lock = threading.Lock()
+
+
+def shared_pool() -> ConnectionPool:
+    """Process-wide pool shared by every provider instance and thread."""
+    global _shared_pool
+    with _shared_lock:
+        if _shared_pool is None:
+            _shared_pool = ConnectionPool()
+        return _shared_pool
+
+
+def raise_for_status(url: str, resp: TransportResponse) -> None:
+    """Raise urllib.error.HTTPError for 4xx/5xx so provider error handling is unchanged."""
+    if resp.status < 400:
+        return
+    raise urllib.error.HTTPError(url, resp.status, resp.reason, resp.headers, io.BytesIO(resp.body))
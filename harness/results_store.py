@@ -0,0 +1,174 @@
+from __future__ import annotations
+
+import json
+import logging
+import os
+import sqlite3
+from datetime import datetime, timezone
+from pathlib import Path
+from typing import Any
+
+log = logging.getLogger(__name__)
+
+STORE_FILENAME = "results.sqlite"
+REPORT_FILENAME = "benchmark_report.json"
+STORE_SCHEMA_VERSION = 1
+
+# Per-task fields kept as typed columns, so slices across runs are plain
+# column scans; everything else stays in the row's JSON.
+TASK_COLUMNS = {
+    "score": "REAL",
+    "tier": "TEXT",
+    "tool_calls_total": "INTEGER",
+    "wall_time_seconds": "REAL",
+    "total_tokens": "INTEGER",
+    "hallucination_count": "INTEGER",
+    "error_occurred": "INTEGER",
+}
+
+# Raw per-phase samples stay in the report; the store keeps their phase_timings summary
+DROPPED_TASK_FIELDS = ("phase_samples",)
+
+_SCHEMA = f"""
+CREATE TABLE IF NOT EXISTS runs (
+    run_id          TEXT PRIMARY KEY,   -- report directory
+    label           TEXT NOT NULL,
+    model           TEXT,
+    provider        TEXT,
+    report_size     INTEGER NOT NULL,
+    report_mtime_ns INTEGER NOT NULL,
+    config          TEXT NOT NULL,      -- JSON
+    aggregate       TEXT NOT NULL,      -- JSON
+    ingested_at     TEXT NOT NULL
+);
+CREATE TABLE IF NOT EXISTS task_results (
+    run_id          TEXT NOT NULL REFERENCES runs(run_id) ON DELETE CASCADE,
+    model           TEXT,
+    task_id         TEXT NOT NULL,
+    {", ".join(f"{name} {kind}" for name, kind in TASK_COLUMNS.items())},
+    metrics         TEXT NOT NULL,      -- JSON TaskMetrics row (less DROPPED_TASK_FIELDS), plus tool_sequence
+    score_result    TEXT,               -- JSON scorer output
+    PRIMARY KEY (run_id, task_id)
+);
+CREATE INDEX IF NOT EXISTS task_results_by_model ON task_results(model, task_id);
+"""
+
+
+class ResultsStore:
+    """SQLite store of benchmark reports, one row per run and per (run, task).
+
+    `ingest` adds a report and skips it while its size and mtime are
+    unchanged, so regenerating the dashboard only reads new or rewritten
+    reports. A rewritten report (e.g. after --resume) replaces its run.
+    """
+
+    def __init__(self, path: Path):
+        self.path = Path(path)
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        self.db = sqlite3.connect(self.path)
+        self.db.row_factory = sqlite3.Row
+        self.db.execute("PRAGMA foreign_keys = ON")
+        version = self.db.execute("PRAGMA user_version").fetchone()[0]
+        if version not in (0, STORE_SCHEMA_VERSION):
+            raise ValueError(f"{self.path}: store schema version {version}, expected {STORE_SCHEMA_VERSION}")
+        self.db.executescript(_SCHEMA)
+        self.db.execute(f"PRAGMA user_version = {STORE_SCHEMA_VERSION}")
+
+    def close(self) -> None:
+        self.db.close()
+
+    def __enter__(self) -> "ResultsStore":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def is_current(self, report_path: Path) -> bool:
+        st = os.stat(report_path)
+        row = self.db.execute(
+            "SELECT report_size, report_mtime_ns FROM runs WHERE run_id = ?", (_run_id(report_path),),
+        ).fetchone()
+        return row is not None and (row[0], row[1]) == (st.st_size, st.st_mtime_ns)
+
+    def ingest(self, report_path: Path, report: dict[str, Any], label: str) -> str:
+        """Store one loaded report (tool sequences already attached); returns its run_id."""
+        run_id = _run_id(report_path)
+        st = os.stat(report_path)
+        config = report.get("config", {})
+        model = config.get("model")
+        scores = {r.get("sample"): r for r in report.get("score_results", [])}
+        with self.db:
+            self.db.execute("DELETE FROM runs WHERE run_id = ?", (run_id,))
+            self.db.execute(
+                "INSERT INTO runs VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                (run_id, label, model, config.get("provider"), st.st_size, st.st_mtime_ns,
+                 json.dumps(config), json.dumps(report.get("aggregate_metrics", {})),
+                 datetime.now(timezone.utc).isoformat(timespec="seconds")),
+            )
+            columns = ", ".join(TASK_COLUMNS)
+            placeholders = ", ".join("?" for _ in TASK_COLUMNS)
+            self.db.executemany(
+                f"INSERT INTO task_results (run_id, model, task_id, {columns}, metrics, score_result) "
+                f"VALUES (?, ?, ?, {placeholders}, ?, ?)",
+                [
+                    (run_id, model, task["task_id"], *(_column(task.get(name)) for name in TASK_COLUMNS),
+                     json.dumps({k: v for k, v in task.items() if k not in DROPPED_TASK_FIELDS}),
+                     json.dumps(scores.get(task["task_id"])))
+                    for task in report.get("task_metrics", [])
+                ],
+            )
+        return run_id
+
+    def prune(self) -> int:
+        """Drop runs whose report has been deleted; returns how many."""
+        stale = [
+            r[0] for r in self.db.execute("SELECT run_id FROM runs")
+            if not (Path(r[0]) / REPORT_FILENAME).exists()
+        ]
+        with self.db:
+            self.db.executemany("DELETE FROM runs WHERE run_id = ?", [(r,) for r in stale])
+        return len(stale)
+
+    def run_summaries(self, run_ids: list[str] | None = None) -> list[dict[str, Any]]:
+        """Per run: label, config, aggregate metrics and a per-task score slice."""
+        runs = self.db.execute("SELECT run_id, label, config, aggregate, report_mtime_ns FROM runs").fetchall()
+        if run_ids is not None:
+            wanted = set(run_ids)
+            runs = [r for r in runs if r["run_id"] in wanted]
+        slices: dict[str, list[dict]] = {}
+        for row in self.db.execute(
+            "SELECT run_id, task_id, score, tier, error_occurred FROM task_results ORDER BY run_id, task_id"
+        ):
+            slices.setdefault(row["run_id"], []).append({
+                "task_id": row["task_id"], "score": row["score"], "tier": row["tier"],
+                "error_occurred": bool(row["error_occurred"]),
+            })
+        return [
+            {
+                "run_id": r["run_id"],
+                "revision": r["report_mtime_ns"],
+                "label": r["label"],
+                "config": json.loads(r["config"]),
+                "aggregate_metrics": json.loads(r["aggregate"]),
+                "task_metrics": slices.get(r["run_id"], []),
+            }
+            for r in runs
+        ]
+
+    def run_detail(self, run_id: str) -> dict[str, Any]:
+        """Full task rows and score results of one run."""
+        rows = self.db.execute(
+            "SELECT metrics, score_result FROM task_results WHERE run_id = ? ORDER BY task_id", (run_id,),
+        ).fetchall()
+        return {
+            "task_metrics": [json.loads(r["metrics"]) for r in rows],
+            "score_results": [json.loads(r["score_result"]) for r in rows if r["score_result"] != "null"],
+        }
+
+
+def _run_id(report_path: Path) -> str:
+    return str(Path(report_path).resolve().parent)
+
+
+def _column(value: Any) -> Any:
+    return int(value) if isinstance(value, bool) else value
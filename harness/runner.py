@@ -1,23 +1,33 @@
 from __future__ import annotations
 
+import dataclasses
 import json
 import logging
 import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import nullcontext
 from dataclasses import dataclass
 from pathlib import Path
-from typing import Any
+from typing import Any, Callable
 
 from .agent import AgentLoop
+from .cache import file_sha256
 from .config import BenchmarkConfig
 from .langfuse import create_langfuse_client
+from .progress import ProgressBoard
 from .metrics import (
+    BOOTSTRAP_CONFIDENCE,
     AggregateMetrics,
     TaskMetrics,
     collect_task_metrics,
     compute_aggregate,
 )
-from .providers import create_provider
+from .providers import create_provider, rate_limiter
+from .sandbox import container_pool
+from .timing import PhaseTimer, merge_samples
 from .tools import ToolExecutor
+from .transcript import TranscriptWriter, find_transcript, read_transcript, transcript_path
 
 log = logging.getLogger(__name__)
 
@@ -31,6 +41,42 @@ class TaskConfig:
     file_type: str = "ELF64"  # Default for backward compatibility
 
 
+BUILD_MANIFEST = "build_manifest.json"
+
+
+def check_build_manifest(tasks: list[TaskConfig], project_root: Path) -> list[str]:
+    """Compare task binaries against the manifest written by build_binaries.sh.
+
+    Returns one message per binary that is missing from the manifest, was
+    modified after the build, or was built from a source that has changed.
+    """
+    problems = []
+    manifests: dict[Path, dict] = {}
+    for task in tasks:
+        binaries_dir = task.binary_path.parent
+        if binaries_dir not in manifests:
+            try:
+                with open(binaries_dir / BUILD_MANIFEST) as f:
+                    manifests[binaries_dir] = json.load(f).get("binaries", {})
+            except (OSError, json.JSONDecodeError):
+                manifests[binaries_dir] = {}
+                problems.append(f"{binaries_dir}: no {BUILD_MANIFEST}; binaries were not built by build_binaries.sh")
+        built = manifests[binaries_dir]
+        if not built or not task.binary_path.exists():
+            continue
+
+        entry = built.get(task.binary_path.name)
+        if entry is None:
+            problems.append(f"{task.task_id}: {task.binary_path.name} is not in {BUILD_MANIFEST}")
+            continue
+        if file_sha256(task.binary_path) != entry.get("sha256"):
+            problems.append(f"{task.task_id}: {task.binary_path.name} was modified after the build")
+        source = project_root / entry.get("source", "")
+        if source.is_file() and file_sha256(source) != entry.get("source_sha256"):
+            problems.append(f"{task.task_id}: {entry['source']} changed since {task.binary_path.name} was built")
+    return problems
+
+
 def load_tasks(manifest_path: Path, project_root: Path) -> list[TaskConfig]:
     with open(manifest_path) as f:
         data = json.load(f)
@@ -52,6 +98,12 @@ def load_tasks(manifest_path: Path, project_root: Path) -> list[TaskConfig]:
                 file_type=file_type,
             )
         )
+
+    problems = check_build_manifest(tasks, project_root)
+    for problem in problems:
+        log.warning("Build check: %s", problem)
+    if problems:
+        log.warning("Rebuild with ./build_binaries.sh (unchanged samples come from the build cache)")
     return tasks
 
 
@@ -105,6 +157,7 @@ def run_single_task(
     task: TaskConfig,
     config: BenchmarkConfig,
     langfuse_client=None,
+    progress_callback: Callable[[], None] | None = None,
 ) -> tuple[TaskMetrics, dict[str, Any]]:
     # Validate binary exists
     if not task.binary_path.exists():
@@ -113,6 +166,14 @@ def run_single_task(
     # Load ground truth
     gt = json.loads(task.ground_truth_path.read_text())
 
+    fingerprint = config.fingerprint()
+    resume_state = None
+    if config.resume:
+        resume_state = _previous_run(task, config, fingerprint)
+        if resume_state is not None and resume_state["complete"]:
+            summary = resume_state["summary"]
+            return TaskMetrics.from_dict(summary["metrics"]), summary["score"]
+
     # Create tool executor
     tool_executor = ToolExecutor(config, task.binary_path)
 
@@ -121,20 +182,48 @@ def run_single_task(
     base_url = config.openai_base_url if config.provider == "openai" else None
     is_bedrock = config.is_bedrock_anthropic if config.provider == "openai" else False
     custom_headers = config.openai_custom_headers if config.provider == "openai" else None
-    provider = create_provider(config.provider, config.model, api_key, base_url, is_bedrock, custom_headers)
+    provider = create_provider(
+        config.provider, config.model, api_key, base_url, is_bedrock, custom_headers,
+        prompt_caching=config.prompt_caching,
+        limiter=rate_limiter(
+            f"{config.provider}:{base_url or ''}",
+            config.requests_per_minute, config.tokens_per_minute, config.max_retries,
+        ),
+        task_id=task.task_id,
+        replay_latency=config.replay_latency,
+    )
 
     # Build system prompt
     system_prompt = build_system_prompt(task, config)
 
+    # Phases outside the agent loop: trace creation and scoring
+    task_timer = PhaseTimer()
     trace_id = None
     if langfuse_client is not None:
-        trace_id = langfuse_client.create_task_trace(
-            task_id=task.task_id,
-            model=config.model,
-            provider=config.provider,
-            difficulty=task.difficulty,
-            metadata={"binary": task.binary_path.name},
-        )
+        with task_timer.phase("langfuse") if langfuse_client.enabled else nullcontext():
+            trace_id = langfuse_client.create_task_trace(
+                task_id=task.task_id,
+                model=config.model,
+                provider=config.provider,
+                difficulty=task.difficulty,
+                metadata={"binary": task.binary_path.name},
+            )
+
+    # Transcript is written as the task runs, so a crash keeps what happened so far
+    transcript = TranscriptWriter(
+        transcript_path(config.transcripts_dir, task.task_id, config.compress_transcripts),
+        compress=config.compress_transcripts,
+    )
+    transcript.header(
+        task_id=task.task_id,
+        model=config.model,
+        provider=config.provider,
+        difficulty=task.difficulty,
+        binary=task.binary_path.name,
+        config_hash=fingerprint,
+        resumed=resume_state is not None,
+        system_prompt=system_prompt,
+    )
 
     # Run agent loop
     agent_loop = AgentLoop(
@@ -145,13 +234,24 @@ def run_single_task(
         file_type=task.file_type,
         max_tool_calls=config.max_tool_calls,
         max_tokens=config.max_tokens,
+        token_budget=config.token_budget,
+        context_tokens=config.context_tokens,
         verbose=config.verbose,
         langfuse=langfuse_client,
         langfuse_trace_id=trace_id,
+        progress_callback=progress_callback,
+        streaming=config.streaming,
+        tool_parallelism=config.tool_parallelism,
+        transcript=transcript,
+        resume_state=resume_state,
     )
+    if config.prefetch_tools and resume_state is None:
+        tool_executor.prefetch(config.prefetch_tools, task.file_type)
     try:
         agent_result = agent_loop.run()
     except Exception as e:
+        transcript.write("error", error=str(e), error_type=type(e).__name__)
+        transcript.close()
         if langfuse_client is not None and trace_id:
             langfuse_client.update_trace(
                 trace_id,
@@ -161,117 +261,144 @@ def run_single_task(
                 status_message="task_failed",
             )
         raise
-
-    # Save agent output
-    config.agent_outputs_dir.mkdir(parents=True, exist_ok=True)
-    agent_output_path = config.agent_outputs_dir / f"{task.task_id}.json"
-
-    final_answer = agent_result.get("final_answer") or {}
-    with open(agent_output_path, "w") as f:
-        json.dump(final_answer, f, indent=2)
-
-    # Score using the existing scorer
-    sys.path.insert(0, str(config.project_root))
-    from scorer import score_sample
-
-    score_result = score_sample(gt, final_answer, str(task.ground_truth_path))
-    score_result["sample"] = task.task_id
-
-    # Collect metrics
-    metrics = collect_task_metrics(task.task_id, agent_result, score_result)
-
-    if langfuse_client is not None and trace_id:
-        langfuse_client.update_trace(
-            trace_id,
-            output={
-                "final_answer": final_answer,
-                "score": score_result,
-            },
-            metadata={
-                "task_id": task.task_id,
-                "tool_call_count": agent_result.get("tool_call_count", 0),
-                "total_tokens": agent_result.get("total_tokens", 0),
-                "wall_time_seconds": agent_result.get("wall_time_seconds", 0),
-                "score": metrics.score,
-                "has_valid_answer": agent_result.get("has_valid_answer", False),
-            },
-            level="DEFAULT",
-            status_message="task_completed",
+    finally:
+        tool_executor.close()
+    agent_result["sandbox_stats"] = tool_executor.sandbox_stats()
+    agent_result["tool_cache_stats"] = tool_executor.tool_cache_stats()
+
+    with transcript:
+        # Save agent output
+        config.agent_outputs_dir.mkdir(parents=True, exist_ok=True)
+        agent_output_path = config.agent_outputs_dir / f"{task.task_id}.json"
+
+        final_answer = agent_result.get("final_answer") or {}
+        with open(agent_output_path, "w") as f:
+            json.dump(final_answer, f, indent=2)
+
+        # Score using the existing scorer
+        sys.path.insert(0, str(config.project_root))
+        from scorer import score_sample
+
+        with task_timer.phase("score"):
+            score_result = score_sample(gt, final_answer, str(task.ground_truth_path))
+        score_result["sample"] = task.task_id
+
+        # Collect metrics
+        agent_result["phase_samples"] = merge_samples(
+            agent_result.get("phase_samples", {}), tool_executor.phase_samples(), task_timer.snapshot(),
         )
+        metrics = collect_task_metrics(task.task_id, agent_result, score_result)
 
-    # Save transcript
-    config.transcripts_dir.mkdir(parents=True, exist_ok=True)
-    transcript_path = config.transcripts_dir / f"{task.task_id}_transcript.json"
-    transcript_data = {
-        "task_id": task.task_id,
-        "model": config.model,
-        "provider": config.provider,
-        "difficulty": task.difficulty,
-        "score": score_result,
-        "agent_result": {
-            k: v
-            for k, v in agent_result.items()
-            if k != "transcript"  # transcript can be huge; save separately if needed
-        },
-        "metrics": metrics.to_dict(),
-    }
-    with open(transcript_path, "w") as f:
-        json.dump(transcript_data, f, indent=2, default=str)
+        if langfuse_client is not None and trace_id:
+            langfuse_client.update_trace(
+                trace_id,
+                output={
+                    "final_answer": final_answer,
+                    "score": score_result,
+                },
+                metadata={
+                    "task_id": task.task_id,
+                    "tool_call_count": agent_result.get("tool_call_count", 0),
+                    "total_tokens": agent_result.get("total_tokens", 0),
+                    "wall_time_seconds": agent_result.get("wall_time_seconds", 0),
+                    "score": metrics.score,
+                    "has_valid_answer": agent_result.get("has_valid_answer", False),
+                },
+                level="DEFAULT",
+                status_message="task_completed",
+            )
 
-    # Save full transcript separately
-    full_transcript_path = config.transcripts_dir / f"{task.task_id}_full_transcript.json"
-    with open(full_transcript_path, "w") as f:
-        json.dump(agent_result.get("transcript", []), f, indent=2, default=str)
+        # The scored summary closes the transcript (messages are already in it)
+        transcript.write(
+            "summary",
+            final_answer=final_answer,
+            score=score_result,
+            agent_result={k: v for k, v in agent_result.items() if k not in ("transcript", "final_answer", "phase_samples")},
+            metrics=metrics.to_dict(),
+        )
 
     return metrics, score_result
 
 
-def run_benchmark(
-    config: BenchmarkConfig,
-    task_filter: str | None = None,
-) -> tuple[AggregateMetrics, list[TaskMetrics], list[dict]]:
-    manifest_path = config.project_root / "tasks.json"
-    tasks = load_tasks(manifest_path, config.project_root)
+def _previous_run(task: TaskConfig, config: BenchmarkConfig, fingerprint: str) -> dict | None:
+    """An earlier transcript of this task under the same config, for --resume.
+
+    Returns the parsed transcript if it either finished cleanly (with its
+    agent output on disk) or has a checkpoint to continue from, which covers
+    tasks that were killed or ended on a provider error; otherwise None, and
+    the task starts over.
+    """
+    path = find_transcript(config.transcripts_dir, task.task_id)
+    if path is None:
+        return None
+    state = read_transcript(path)
+    if state["header"].get("config_hash") != fingerprint:
+        log.info("[%s] Previous transcript has a different config; starting over", task.task_id)
+        return None
+    if state["complete"]:
+        error_info = state["summary"].get("agent_result", {}).get("error_info", {})
+        if not error_info.get("error_occurred"):
+            return state if (config.agent_outputs_dir / f"{task.task_id}.json").exists() else None
+        # Ended on a provider error (e.g. an HTTP 500): retry from the failed step
+        state["complete"] = False
+    if state["checkpoint"] is None:
+        return None
+    # The transcript is rewritten from the checkpoint under the current name
+    if path != transcript_path(config.transcripts_dir, task.task_id, config.compress_transcripts):
+        path.unlink()
+    return state
+
+
+def calls_summary(metrics: TaskMetrics) -> str:
+    """"7 calls", plus the tokens used of the budget when the task had one."""
+    text = f"{metrics.tool_calls_total} calls"
+    if metrics.token_budget:
+        text += f", {metrics.total_tokens:,}/{metrics.token_budget:,} tokens"
+    return text
+
+
+def _report_task_failure(task: TaskConfig, config: BenchmarkConfig, langfuse_client, e: Exception) -> None:
+    log.error("Task %s failed: %s", task.task_id, e, exc_info=True)
+    if config.langfuse_enabled:
+        langfuse_client.create_event(
+            trace_id=None,
+            name="task_failed_unhandled",
+            output={"task_id": task.task_id, "error": str(e)},
+            level="ERROR",
+        )
 
-    if task_filter:
-        tasks = [t for t in tasks if t.task_id == task_filter]
-        if not tasks:
-            raise ValueError(f"No task found matching {task_filter!r}")
 
-    total = len(tasks)
-    mode = "docker" if config.use_docker else "local"
+def trial_config(config: BenchmarkConfig, trial: int) -> BenchmarkConfig:
+    """Trial N > 0 of a run keeps its transcripts and report in <results_dir>/trial_N."""
+    if not trial:
+        return config
+    return dataclasses.replace(config, results_dir=config.results_dir / f"trial_{trial}")
 
-    # Banner
-    print(f"\n{'='*60}")
-    print(f"  AgentRE-Bench")
-    print(f"  {config.provider}/{config.model} | {total} task{'s' if total != 1 else ''} | {mode}")
-    print(f"{'='*60}")
 
-    all_metrics: list[TaskMetrics] = []
-    all_scores: list[dict] = []
-    langfuse_client = create_langfuse_client(
-        public_key=config.langfuse_public_key,
-        secret_key=config.langfuse_secret_key,
-        host=config.langfuse_host,
-    )
-    if config.langfuse_enabled:
-        print(f"  Langfuse: enabled ({config.langfuse_host})")
+def _task_label(task: TaskConfig, trial: int, trials: int) -> str:
+    return f"{task.task_id} trial {trial}" if trials > 1 else task.task_id
 
-    for i, task in enumerate(tasks, 1):
+
+def _run_serial(
+    runs: list[tuple[TaskConfig, BenchmarkConfig, str]],
+    langfuse_client,
+) -> list[tuple[TaskMetrics, dict] | None]:
+    total = len(runs)
+    results: list[tuple[TaskMetrics, dict] | None] = []
+    for i, (task, config, name) in enumerate(runs, 1):
         if config.verbose:
             # Verbose: full header, agent prints detailed output
             print(f"\n{'─'*60}")
-            print(f"  [{i}/{total}] {task.task_id}  (difficulty {task.difficulty})")
+            print(f"  [{i}/{total}] {name}  (difficulty {task.difficulty})")
             print(f"{'─'*60}")
         else:
             # Non-verbose: print task name, dots will follow from agent
-            label = f"  [{i:>{len(str(total))}}/{total}] {task.task_id}"
+            label = f"  [{i:>{len(str(total))}}/{total}] {name}"
             print(f"{label} ", end="", flush=True)
 
         try:
             metrics, score_result = run_single_task(task, config, langfuse_client=langfuse_client)
-            all_metrics.append(metrics)
-            all_scores.append(score_result)
+            results.append((metrics, score_result))
 
             if config.verbose:
                 print(
@@ -284,50 +411,257 @@ def run_benchmark(
                 # Complete the line after dots
                 print(
                     f" {metrics.score:.4f}  "
-                    f"({metrics.tool_calls_total} calls, "
+                    f"({calls_summary(metrics)}, "
                     f"{metrics.wall_time_seconds:.1f}s)"
                 )
         except Exception as e:
-            log.error("Task %s failed: %s", task.task_id, e, exc_info=True)
-            if config.langfuse_enabled:
-                langfuse_client.create_event(
-                    trace_id=None,
-                    name="task_failed_unhandled",
-                    output={"task_id": task.task_id, "error": str(e)},
-                    level="ERROR",
-                )
+            _report_task_failure(task, config, langfuse_client, e)
+            results.append(None)
             if config.verbose:
                 print(f"\n  FAILED: {e}")
             else:
                 print(f" FAILED")
-            continue
+    return results
+
+
+_provider_slots_lock = threading.Lock()
+_provider_slots: dict[str, threading.BoundedSemaphore] = {}
+
+
+def provider_slot(provider: str, limit: int) -> threading.BoundedSemaphore:
+    """Process-wide semaphore capping concurrent tasks per provider."""
+    with _provider_slots_lock:
+        sem = _provider_slots.get(provider)
+        if sem is None:
+            sem = threading.BoundedSemaphore(limit)
+            _provider_slots[provider] = sem
+        return sem
+
+
+def _run_parallel(
+    runs: list[tuple[TaskConfig, BenchmarkConfig, str]],
+    langfuse_client,
+    jobs: int,
+) -> list[tuple[TaskMetrics, dict] | None]:
+    total = len(runs)
+    labels = [
+        f"  [{i:>{len(str(total))}}/{total}] {name}"
+        for i, (_, _, name) in enumerate(runs, 1)
+    ]
+    board = ProgressBoard(labels)
+    config = runs[0][1]
+    slot = provider_slot(config.provider, config.provider_concurrency or jobs)
+
+    def worker(idx: int, task: TaskConfig, config: BenchmarkConfig) -> tuple[TaskMetrics, dict] | None:
+        with slot:
+            board.start(idx)
+            try:
+                metrics, score_result = run_single_task(
+                    task,
+                    config,
+                    langfuse_client=langfuse_client,
+                    progress_callback=lambda: board.tick(idx),
+                )
+            except Exception as e:
+                _report_task_failure(task, config, langfuse_client, e)
+                board.finish(idx, "FAILED")
+                return None
+        board.finish(
+            idx,
+            f"{metrics.score:.4f}  "
+            f"({calls_summary(metrics)}, "
+            f"{metrics.wall_time_seconds:.1f}s)",
+        )
+        return metrics, score_result
 
-    # Compute aggregate metrics
-    aggregate = compute_aggregate(all_metrics)
+    with ThreadPoolExecutor(max_workers=jobs) as pool:
+        futures = [pool.submit(worker, i, task, config) for i, (task, config, _) in enumerate(runs)]
+        return [f.result() for f in futures]
+
+
+def run_benchmark(
+    config: BenchmarkConfig,
+    task_filter: str | None = None,
+    trials: int = 1,
+) -> tuple[AggregateMetrics, list[TaskMetrics], list[dict]]:
+    """Run the tasks (each `trials` times) and write the report(s).
+
+    With several trials, a task's trials run side by side on the --jobs
+    pool (at least one job per trial), so they share the tool-output cache
+    while it is filled and, with --pooled-sandbox, the sandbox containers.
+    Each trial gets its own benchmark_report.json (trial N > 0 under
+    trial_N/, as with --enqueue) and trials_report.json sums them up.
+    """
+    manifest_path = config.project_root / "tasks.json"
+    tasks = load_tasks(manifest_path, config.project_root)
+
+    if task_filter:
+        tasks = [t for t in tasks if t.task_id == task_filter]
+        if not tasks:
+            raise ValueError(f"No task found matching {task_filter!r}")
+
+    total = len(tasks)
+    trials = max(1, trials)
+    mode = "docker" if config.use_docker else "local"
+    if config.use_docker and config.pooled_sandbox:
+        mode = "docker (pooled)"
+        if trials > 1:
+            config = dataclasses.replace(config, container_pool=True)
+            mode = "docker (pooled, shared)"
+
+    # Banner
+    print(f"\n{'='*60}")
+    print(f"  AgentRE-Bench")
+    print(f"  {config.provider}/{config.model} | {total} task{'s' if total != 1 else ''}"
+          + (f" x {trials} trials" if trials > 1 else "") + f" | {mode}")
+    print(f"{'='*60}")
+
+    all_metrics: list[TaskMetrics] = []
+    all_scores: list[dict] = []
+    langfuse_client = create_langfuse_client(
+        public_key=config.langfuse_public_key,
+        secret_key=config.langfuse_secret_key,
+        host=config.langfuse_host,
+    )
+    if config.langfuse_enabled:
+        print(f"  Langfuse: enabled ({config.langfuse_host})")
+
+    jobs = max(1, config.jobs, trials)
+    if jobs > 1 and config.verbose:
+        print("  Note: --verbose output cannot be interleaved; running with --jobs 1")
+        jobs = 1
+
+    # Task-major: a task's trials are started together
+    runs = [
+        (task, trial_config(config, trial), _task_label(task, trial, trials))
+        for task in tasks for trial in range(trials)
+    ]
+    try:
+        if jobs == 1:
+            results = _run_serial(runs, langfuse_client)
+        else:
+            print(f"  Jobs: {jobs} (max {config.provider_concurrency or jobs} per provider)")
+            results = _run_parallel(runs, langfuse_client, jobs)
+    finally:
+        # Traces are sent in the background; drain the queue before reporting
+        langfuse_client.shutdown()
+        if config.container_pool:
+            container_pool.close()
+
+    # Report order follows the manifest regardless of completion order
+    per_trial: list[tuple[list[TaskMetrics], list[dict]]] = [([], []) for _ in range(trials)]
+    for n, result in enumerate(results):
+        if result is not None:
+            metrics, score_result = result
+            metrics.trial = n % trials
+            per_trial[metrics.trial][0].append(metrics)
+            per_trial[metrics.trial][1].append(score_result)
+            all_metrics.append(metrics)
+            all_scores.append(score_result)
 
     # Print summary via scorer
     sys.path.insert(0, str(config.project_root))
     from scorer import print_summary
 
-    print_summary(all_scores)
+    if trials == 1:
+        print_summary(all_scores)
+        aggregate, report_path = write_report(config, all_metrics, all_scores)
+        print(f"\nReport saved to {report_path}")
+        return aggregate, all_metrics, all_scores
 
-    # Save benchmark report
+    print_summary(per_trial[0][1])
+    trial_reports = {trial: write_report(trial_config(config, trial), *per_trial[trial])[1] for trial in range(trials)}
+    aggregate, report_path = write_trials_report(config, all_metrics, trial_reports)
+    print_trial_stats(aggregate)
+    print(f"\nPer-trial reports saved to {config.results_dir}, trial_1..{trials - 1}/")
+    print(f"Trials report saved to {report_path}")
+
+    return aggregate, all_metrics, all_scores
+
+
+def write_report(
+    config: BenchmarkConfig,
+    all_metrics: list[TaskMetrics],
+    all_scores: list[dict],
+) -> tuple[AggregateMetrics, Path]:
+    """Aggregate task results and write <results_dir>/benchmark_report.json."""
+    aggregate = compute_aggregate(all_metrics)
     config.results_dir.mkdir(parents=True, exist_ok=True)
     report_path = config.results_dir / "benchmark_report.json"
     report = {
-        "config": {
-            "model": config.model,
-            "provider": config.provider,
-            "max_tool_calls": config.max_tool_calls,
-            "use_docker": config.use_docker,
-        },
+        "config": _report_config(config),
         "aggregate_metrics": aggregate.to_dict(),
         "task_metrics": [m.to_dict() for m in all_metrics],
         "score_results": all_scores,
     }
     with open(report_path, "w") as f:
         json.dump(report, f, indent=2, default=str)
+    return aggregate, report_path
 
-    print(f"\nReport saved to {report_path}")
 
-    return aggregate, all_metrics, all_scores
+def write_trials_report(
+    config: BenchmarkConfig,
+    all_metrics: list[TaskMetrics],
+    trial_reports: dict[int, Path],
+) -> tuple[AggregateMetrics, Path]:
+    """Aggregate every trial's tasks and write <results_dir>/trials_report.json.
+
+    The aggregate pools all trials (so its trial_stats are filled in); the
+    per-trial task metrics stay in the trials' own benchmark_report.json.
+    """
+    aggregate = compute_aggregate(all_metrics)
+    scores: dict[str, list[float | None]] = {}
+    for m in all_metrics:
+        scores.setdefault(m.task_id, [None] * (max(trial_reports) + 1))[m.trial] = m.score
+    report = {
+        "config": _report_config(config),
+        "aggregate_metrics": aggregate.to_dict(),
+        "trials": [
+            {
+                "trial": trial,
+                "report": str(path),
+                "total_score": round(compute_aggregate([m for m in all_metrics if m.trial == trial]).total_score, 4),
+            }
+            for trial, path in sorted(trial_reports.items())
+        ],
+        "task_scores": scores,
+    }
+    config.results_dir.mkdir(parents=True, exist_ok=True)
+    report_path = config.results_dir / "trials_report.json"
+    with open(report_path, "w") as f:
+        json.dump(report, f, indent=2, default=str)
+    return aggregate, report_path
+
+
+def print_trial_stats(aggregate: AggregateMetrics) -> None:
+    confidence = f"{BOOTSTRAP_CONFIDENCE:.0%} CI"
+    print(f"\n  {'Across ' + str(aggregate.trials) + ' trials':<26} {'Mean':>10} {'Std':>10} {confidence:>23}")
+    print("  " + "-" * 72)
+    for name, s in aggregate.trial_stats.items():
+        print(f"  {name:<26} {s['mean']:>10.4f} {s['std']:>10.4f} "
+              f"{'[' + format(s['ci_low'], '.4f') + ', ' + format(s['ci_high'], '.4f') + ']':>23}")
+
+
+def _report_config(config: BenchmarkConfig) -> dict[str, Any]:
+    return {
+        "model": config.model,
+        "provider": config.provider,
+        "max_tool_calls": config.max_tool_calls,
+        "token_budget": config.token_budget,
+        "context_tokens": config.context_tokens,
+        "prompt_caching": config.prompt_caching,
+        "streaming": config.streaming,
+        "tool_parallelism": config.tool_parallelism,
+        "requests_per_minute": config.requests_per_minute,
+        "tokens_per_minute": config.tokens_per_minute,
+        "max_retries": config.max_retries,
+        "paged_output": config.paged_output,
+        "use_docker": config.use_docker,
+        "pooled_sandbox": config.pooled_sandbox,
+        "tool_cache_enabled": config.tool_cache_enabled,
+        "binary_index_enabled": config.binary_index_enabled,
+        "analysis_server": config.analysis_server,
+        "prefetch_tools": config.prefetch_tools,
+        "replay_latency": config.replay_latency,
+        "config_hash": config.fingerprint(),
+    }
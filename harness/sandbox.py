@@ -1,12 +1,27 @@
 from __future__ import annotations
 
+import json
 import logging
+import os
+import selectors
 import subprocess
+import sys
+import threading
+import time
+import uuid
 from dataclasses import dataclass
 from pathlib import Path
+from typing import Callable
+
+from .timing import PhaseTimer
 
 log = logging.getLogger(__name__)
 
+READ_CHUNK = 64 * 1024
+# A tool's stdio writes a pipe in blocks of this size
+PIPE_WRITE_BLOCK = 4096
+TRUNCATION_MARKER = "\n... [output truncated]"
+
 
 @dataclass
 class RunResult:
@@ -15,6 +30,281 @@ class RunResult:
     returncode: int
     truncated: bool = False
     timed_out: bool = False
+    # Bytes the tool wrote to stdout + stderr. Exact unless stopped_early,
+    # in which case it is what was read before the process was killed (for
+    # index hits, an estimate of that; see bytes_read_before_stop).
+    output_bytes: int = 0
+    stopped_early: bool = False
+    # Peak RSS of the spawned process (for Docker runners, the docker client),
+    # in KB; 0 when not measured, e.g. for cache and index hits. The kernel
+    # counts the spawning process's footprint before exec, so it is never
+    # below the harness's own RSS.
+    max_rss_kb: int = 0
+    # The tool never ran: the sandbox could not start, its executable is
+    # missing, or the resident server died. Not cached or indexed.
+    sandbox_failed: bool = False
+
+
+class _BoundedBuffer:
+    """Accumulates one pipe until its decoded text exceeds `limit` chars; later
+    data is only counted."""
+
+    def __init__(self, limit: int):
+        self.limit = limit
+        self.chunks: list[bytes] = []
+        self.size = 0
+        self.full = False
+
+    def add(self, data: bytes) -> None:
+        self.size += len(data)
+        if self.full:
+            return
+        self.chunks.append(data)
+        # A char is at least one byte, so only decode once bytes pass the limit
+        if self.size > self.limit and len(self.text()) > self.limit:
+            self.full = True
+
+    def text(self) -> str:
+        text = b"".join(self.chunks).decode("utf-8", errors="replace")
+        # Same newline handling as subprocess text mode
+        return text.replace("\r\n", "\n").replace("\r", "\n")
+
+
+def bytes_read_before_stop(raw: bytes, limit: int) -> int:
+    """Bytes of `raw` _capture has read when it kills a tool for passing `limit`
+    stdout chars: up to the first char past the limit, rounded up to the
+    block the tool wrote it in."""
+    needed = len(raw.decode("utf-8", errors="replace")[:limit + 1].encode("utf-8"))
+    return min(len(raw), -(-needed // PIPE_WRITE_BLOCK) * PIPE_WRITE_BLOCK)
+
+
+def _truncate(text: str, limit: int) -> tuple[str, bool]:
+    if len(text) > limit:
+        return text[:limit] + TRUNCATION_MARKER, True
+    return text, False
+
+
+def _capture(
+    cmd: list[str],
+    timeout: float,
+    max_output_chars: int,
+    cwd: str | None = None,
+    on_abort: Callable[[], None] | None = None,
+) -> RunResult:
+    """Run `cmd`, reading its output incrementally with a hard size bound.
+
+    Once stdout holds more than `max_output_chars` characters the child is
+    killed instead of being left to write (and us to buffer) megabytes that
+    would be truncated anyway. A full stderr is still drained (and discarded),
+    so a tool that spews warnings is not killed by SIGPIPE. `on_abort` runs
+    after an early kill or timeout, e.g. to stop a container the child was
+    only a client for.
+    """
+    proc = subprocess.Popen(
+        cmd, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=cwd,
+    )
+    out = _BoundedBuffer(max_output_chars)
+    err = _BoundedBuffer(max_output_chars)
+    buffers = {proc.stdout.fileno(): out, proc.stderr.fileno(): err}
+    pipes = (proc.stdout, proc.stderr)
+
+    deadline = time.monotonic() + timeout
+    timed_out = stopped_early = False
+    with selectors.DefaultSelector() as sel:
+        for fd in buffers:
+            sel.register(fd, selectors.EVENT_READ)
+        while sel.get_map():
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                timed_out = True
+                break
+            for key, _ in sel.select(remaining):
+                data = os.read(key.fd, READ_CHUNK)
+                if not data:
+                    sel.unregister(key.fd)
+                    continue
+                buffers[key.fd].add(data)
+            if out.full:
+                stopped_early = True
+                break
+
+    if timed_out or stopped_early:
+        proc.kill()
+        if on_abort is not None:
+            on_abort()
+    returncode, max_rss_kb = _wait(proc, timeout=5)
+    for pipe in pipes:
+        pipe.close()
+
+    stdout, out_truncated = _truncate(out.text(), max_output_chars)
+    stderr, err_truncated = _truncate(err.text(), max_output_chars)
+    return RunResult(
+        stdout=stdout,
+        stderr=stderr,
+        returncode=-1 if timed_out else returncode,
+        truncated=out_truncated or err_truncated,
+        timed_out=timed_out,
+        output_bytes=out.size + err.size,
+        stopped_early=stopped_early,
+        max_rss_kb=max_rss_kb,
+    )
+
+
+def _wait(proc: subprocess.Popen, timeout: float) -> tuple[int, int]:
+    """Reap `proc` like Popen.wait(timeout), also returning its peak RSS in KB.
+
+    Returns -1 as the exit code if it is still running after `timeout`. The
+    RSS is 0 when Popen already reaped the child (kill() polls first).
+    """
+    if proc.returncode is not None or not hasattr(os, "wait4"):
+        try:
+            return proc.wait(timeout=timeout), 0
+        except subprocess.TimeoutExpired:
+            return -1, 0
+    deadline = time.monotonic() + timeout
+    delay = 0.0005
+    while True:
+        try:
+            pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+        except ChildProcessError:
+            return proc.wait(), 0
+        if pid:
+            proc.returncode = os.waitstatus_to_exitcode(status)
+            # ru_maxrss is in KB on Linux, bytes on macOS
+            rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+            return proc.returncode, rss
+        if time.monotonic() >= deadline:
+            return -1, 0
+        time.sleep(delay)
+        delay = min(delay * 2, 0.01)
+
+
+class ResidentServer:
+    """A long-lived helper process answering one JSON request per line.
+
+    Started by the runner on first use (see tools/analyzer.py for the
+    protocol). Requests are serialized; a server that exits, hangs past the
+    timeout or answers garbage is killed and started again on the next call.
+    """
+
+    def __init__(
+        self,
+        spawn_cmd: list[str],
+        timeout: int,
+        max_output_chars: int,
+        cwd: str | None = None,
+        on_abort: Callable[[], None] | None = None,
+    ):
+        self.spawn_cmd = spawn_cmd
+        self.timeout = timeout
+        self.max_output_chars = max_output_chars
+        self.cwd = cwd
+        self.on_abort = on_abort
+        self.proc: subprocess.Popen | None = None
+        self.starts = 0
+        self.answered = 0
+        self.unavailable = False   # could not start, or never answered: callers fall back
+        self._lock = threading.Lock()
+
+    def _start(self) -> None:
+        log.debug("Resident server start: %s", " ".join(self.spawn_cmd))
+        self.proc = subprocess.Popen(
+            self.spawn_cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+            stderr=subprocess.DEVNULL, cwd=self.cwd,
+        )
+        self.starts += 1
+
+    def request(self, command: list[str]) -> RunResult | None:
+        """Run `command` on the server; None if it could not be started."""
+        with self._lock:
+            if self.unavailable:
+                return None
+            if self.proc is None or self.proc.poll() is not None:
+                try:
+                    self._start()
+                except OSError as e:
+                    log.warning("Resident server %s failed to start: %s", self.spawn_cmd[0], e)
+                    self.unavailable = True
+                    return None
+            request = {"argv": command, "limit": self.max_output_chars, "timeout": self.timeout}
+            line = b""
+            try:
+                self.proc.stdin.write((json.dumps(request) + "\n").encode("utf-8"))
+                self.proc.stdin.flush()
+                line = self._readline(self.timeout + 5)
+                response = json.loads(line) if line else None
+            except (OSError, ValueError):
+                response = None
+            else:
+                self.answered += response is not None
+            if response is None:
+                timed_out = line is None
+                self._stop()
+                if not timed_out and not self.answered:
+                    # Died before ever answering: e.g. not installed in this image
+                    log.warning("Resident server %s exited without answering; not using it",
+                                self.spawn_cmd[0])
+                    self.unavailable = True
+                    return None
+                return RunResult(
+                    stdout="",
+                    stderr="Resident server timed out" if timed_out else "Resident server exited",
+                    returncode=-1,
+                    timed_out=timed_out,
+                    sandbox_failed=True,
+                )
+
+        stdout, out_truncated = _truncate(response["stdout"], self.max_output_chars)
+        stderr, err_truncated = _truncate(response["stderr"], self.max_output_chars)
+        return RunResult(
+            stdout=stdout,
+            stderr=stderr,
+            returncode=-1 if response["timed_out"] else response["returncode"],
+            truncated=out_truncated or err_truncated,
+            timed_out=response["timed_out"],
+            output_bytes=response["output_bytes"],
+            stopped_early=response["stopped_early"],
+        )
+
+    def _readline(self, timeout: float) -> bytes | None:
+        """One response line; b"" at EOF, None on timeout."""
+        fd = self.proc.stdout.fileno()
+        deadline = time.monotonic() + timeout
+        chunks: list[bytes] = []
+        with selectors.DefaultSelector() as sel:
+            sel.register(fd, selectors.EVENT_READ)
+            while True:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0 or not sel.select(remaining):
+                    return None
+                data = os.read(fd, READ_CHUNK)
+                if not data:
+                    return b""
+                chunks.append(data)
+                if data.endswith(b"\n"):
+                    return b"".join(chunks)
+
+    def _stop(self) -> None:
+        if self.proc is None:
+            return
+        proc, self.proc = self.proc, None
+        if proc.poll() is None:
+            proc.kill()
+            if self.on_abort is not None:
+                self.on_abort()
+        proc.wait()
+        for pipe in (proc.stdin, proc.stdout):
+            pipe.close()
+
+    def close(self) -> None:
+        with self._lock:
+            if self.proc is not None and self.proc.poll() is None:
+                try:
+                    self.proc.stdin.close()   # end of input: the server exits
+                    self.proc.wait(timeout=2)
+                except (OSError, subprocess.TimeoutExpired):
+                    pass
+            self._stop()
 
 
 class PathValidator:
@@ -44,7 +334,47 @@ class PathValidator:
         return path
 
 
-class DockerRunner:
+class _ResidentServers:
+    """`serve()` for the runners: one ResidentServer per server command, in the sandbox."""
+
+    _servers: dict[tuple[str, ...], ResidentServer | None]
+    _servers_lock: threading.Lock
+
+    def serve(self, server_cmd: list[str], command: list[str]) -> RunResult | None:
+        """Run `command` on a resident `server_cmd`; None if no server can run here."""
+        key = tuple(server_cmd)
+        with self._servers_lock:
+            if key not in self._servers:
+                self._servers[key] = self._resident_server(server_cmd)
+            server = self._servers[key]
+        if server is None:
+            return None
+        start = time.monotonic()
+        result = server.request(command)
+        if result is not None:
+            self._record(time.monotonic() - start)
+            self._record_output(result)
+        return result
+
+    def _resident_server(self, server_cmd: list[str]) -> ResidentServer | None:
+        raise NotImplementedError
+
+    def _close_servers(self) -> None:
+        with self._servers_lock:
+            servers, self._servers = self._servers, {}
+        for server in servers.values():
+            if server is not None:
+                server.close()
+
+
+def _docker_kill(name: str) -> None:
+    try:
+        subprocess.run(["docker", "kill", name], capture_output=True, timeout=10)
+    except (subprocess.TimeoutExpired, FileNotFoundError) as e:
+        log.warning("Failed to kill container %s: %s", name, e)
+
+
+class DockerRunner(_ResidentServers):
     def __init__(
         self,
         image: str,
@@ -57,9 +387,19 @@ class DockerRunner:
         self.timeout = timeout
         self.max_output_chars = max_output_chars
 
-    def run(self, command: list[str]) -> RunResult:
-        docker_cmd = [
-            "docker", "run", "--rm",
+        # Timing: every call pays container startup, so it is all exec time
+        self.startup_seconds = 0.0
+        self.exec_seconds = 0.0
+        self.exec_count = 0
+        self.output_bytes = 0      # bytes read from tool stdout/stderr
+        self.early_stops = 0       # tools killed once their output hit the limit
+        self._stats_lock = threading.Lock()   # tool calls may run concurrently
+        self.timer = PhaseTimer()
+        self._servers = {}
+        self._servers_lock = threading.Lock()
+
+    def _isolation_flags(self) -> list[str]:
+        return [
             "--platform", "linux/amd64",
             "--network=none",
             "--read-only",
@@ -67,48 +407,220 @@ class DockerRunner:
             f"--cpus=1",
             "-v", f"{self.workspace_dir}:/workspace:ro",
             "-w", "/workspace",
-            self.image,
-        ] + command
+        ]
+
+    def run(self, command: list[str]) -> RunResult:
+        # Named so an early stop can kill the container, not just the client
+        name = f"agentre-tool-{uuid.uuid4().hex[:12]}"
+        docker_cmd = (
+            ["docker", "run", "--rm", "--name", name]
+            + self._isolation_flags() + [self.image] + command
+        )
 
         log.debug("Docker command: %s", " ".join(docker_cmd))
-        return self._exec(docker_cmd)
+        start = time.monotonic()
+        result = self._exec(docker_cmd, on_abort=lambda: _docker_kill(name))
+        self._record(time.monotonic() - start)
+        return _mark_docker_failure(result)
+
+    def _record(self, elapsed: float) -> None:
+        with self._stats_lock:
+            self.exec_seconds += elapsed
+            self.exec_count += 1
+        self.timer.add("sandbox_exec", elapsed)
+
+    def _record_output(self, result: RunResult) -> None:
+        with self._stats_lock:
+            self.output_bytes += result.output_bytes
+            self.early_stops += result.stopped_early
+
+    def stats(self) -> dict[str, float | int]:
+        return {
+            "startup_seconds": round(self.startup_seconds, 3),
+            "exec_seconds": round(self.exec_seconds, 3),
+            "exec_count": self.exec_count,
+            "output_bytes": self.output_bytes,
+            "early_stops": self.early_stops,
+        }
 
-    def _exec(self, cmd: list[str]) -> RunResult:
-        timed_out = False
+    def _resident_server(self, server_cmd: list[str]) -> ResidentServer | None:
+        # Its own container, alive as long as the server reads stdin
+        name = f"agentre-server-{uuid.uuid4().hex[:12]}"
+        return ResidentServer(
+            ["docker", "run", "-i", "--rm", "--name", name] + self._isolation_flags() + [self.image] + server_cmd,
+            self.timeout, self.max_output_chars, on_abort=lambda: _docker_kill(name),
+        )
+
+    def close(self) -> None:
+        self._close_servers()
+
+    def _exec(self, cmd: list[str], on_abort: Callable[[], None] | None = None) -> RunResult:
         try:
-            proc = subprocess.run(
-                cmd,
-                capture_output=True,
-                text=True,
-                timeout=self.timeout,
+            result = _capture(cmd, self.timeout, self.max_output_chars, on_abort=on_abort)
+        except FileNotFoundError:
+            return RunResult(stdout="", stderr=f"Command not found: {cmd[0]}", returncode=127,
+                             sandbox_failed=True)
+        self._record_output(result)
+        return result
+
+
+# docker run / exec exit codes for "daemon error", "cannot invoke" and "not found"
+_DOCKER_FAILURE_CODES = (125, 126, 127)
+
+
+def _mark_docker_failure(result: RunResult) -> RunResult:
+    """Flag a docker run or exec that never got the tool running."""
+    if result.returncode in _DOCKER_FAILURE_CODES and not result.timed_out:
+        result.sandbox_failed = True
+    return result
+
+
+def _docker_rm(name: str) -> None:
+    try:
+        subprocess.run(["docker", "rm", "-f", name], capture_output=True, timeout=30)
+    except (subprocess.TimeoutExpired, FileNotFoundError) as e:
+        log.warning("Failed to remove sandbox container %s: %s", name, e)
+
+
+class ContainerPool:
+    """Idle pooled-sandbox containers, handed from one finished task to the next.
+
+    A task still gets a container to itself (and its CPU and memory caps),
+    but only the first tasks pay the container start; the rest reuse what
+    earlier tasks released. Used by sweeps, where every model runs the same
+    tasks. close() removes the containers.
+    """
+
+    def __init__(self):
+        self._idle: dict[tuple[str, str], list[str]] = {}
+        self._all: list[str] = []
+        self._lock = threading.Lock()
+
+    def acquire(self, runner: "PooledDockerRunner") -> RunResult | None:
+        """Point `runner` at an idle container, or start a new one; the start's failure if any."""
+        key = (runner.image, str(runner.workspace_dir))
+        with self._lock:
+            idle = self._idle.get(key)
+            if idle:
+                runner.container_name = idle.pop()
+                return None
+        failed = runner._start_container()
+        if failed is None:
+            with self._lock:
+                self._all.append(runner.container_name)
+        return failed
+
+    def release(self, runner: "PooledDockerRunner") -> None:
+        with self._lock:
+            self._idle.setdefault((runner.image, str(runner.workspace_dir)), []).append(runner.container_name)
+
+    def close(self) -> None:
+        with self._lock:
+            names, self._all, self._idle = self._all, [], {}
+        for name in names:
+            _docker_rm(name)
+
+
+container_pool = ContainerPool()
+
+
+class PooledDockerRunner(DockerRunner):
+    """One long-lived hardened container per task; tools run via `docker exec`.
+
+    The container is started lazily on the first call with the same
+    isolation flags as DockerRunner and removed by close(), or taken from
+    and returned to a ContainerPool.
+    """
+
+    def __init__(
+        self,
+        image: str,
+        workspace_dir: Path,
+        timeout: int = 30,
+        max_output_chars: int = 8000,
+        pool: ContainerPool | None = None,
+    ):
+        super().__init__(image, workspace_dir, timeout, max_output_chars)
+        self.container_name = f"agentre-sandbox-{uuid.uuid4().hex[:12]}"
+        self.pool = pool
+        self._started = False
+        self._lock = threading.Lock()
+
+    def _ensure_started(self) -> RunResult | None:
+        with self._lock:
+            if self._started:
+                return None
+            failed = self.pool.acquire(self) if self.pool is not None else self._start_container()
+            if failed is not None:
+                return failed
+            self._started = True
+            return None
+
+    def _start_container(self) -> RunResult | None:
+        docker_cmd = (
+            ["docker", "run", "-d", "--rm", "--name", self.container_name]
+            + self._isolation_flags()
+            + ["--entrypoint", "sleep", self.image, "infinity"]
+        )
+        log.debug("Docker pool start: %s", " ".join(docker_cmd))
+        start = time.monotonic()
+        result = self._exec(docker_cmd)
+        elapsed = time.monotonic() - start
+        self.startup_seconds += elapsed
+        self.timer.add("sandbox_startup", elapsed)
+        return result if result.returncode != 0 else None
+
+    def run(self, command: list[str]) -> RunResult:
+        failed = self._ensure_started()
+        if failed is not None:
+            return RunResult(
+                stdout="",
+                stderr=f"Failed to start sandbox container: {failed.stderr.strip()}",
+                returncode=failed.returncode,
+                timed_out=failed.timed_out,
+                sandbox_failed=True,
             )
-            stdout = proc.stdout
-            stderr = proc.stderr
-            returncode = proc.returncode
-        except subprocess.TimeoutExpired as e:
-            stdout = (e.stdout or b"").decode("utf-8", errors="replace")
-            stderr = (e.stderr or b"").decode("utf-8", errors="replace")
-            returncode = -1
-            timed_out = True
-
-        truncated = False
-        if len(stdout) > self.max_output_chars:
-            stdout = stdout[: self.max_output_chars] + "\n... [output truncated]"
-            truncated = True
-        if len(stderr) > self.max_output_chars:
-            stderr = stderr[: self.max_output_chars] + "\n... [output truncated]"
-            truncated = True
 
-        return RunResult(
-            stdout=stdout,
-            stderr=stderr,
-            returncode=returncode,
-            truncated=truncated,
-            timed_out=timed_out,
+        # `timeout` inside the container kills the tool itself; killing the
+        # docker exec client alone would leave it running in the container.
+        # (After an early stop on the output limit the orphaned tool just
+        # blocks on its unread pipe until `timeout` reaps it.)
+        docker_cmd = [
+            "docker", "exec", self.container_name,
+            "timeout", "-s", "KILL", str(self.timeout),
+        ] + command
+
+        log.debug("Docker exec: %s", " ".join(docker_cmd))
+        start = time.monotonic()
+        result = self._exec(docker_cmd)
+        self._record(time.monotonic() - start)
+        if result.returncode == 137 and not result.timed_out:
+            result.timed_out = True
+        return _mark_docker_failure(result)
+
+    def _resident_server(self, server_cmd: list[str]) -> ResidentServer | None:
+        if self._ensure_started() is not None:
+            return None
+        # A killed exec client closes the server's stdin, and the server's
+        # own per-request alarm bounds a stuck one
+        return ResidentServer(
+            ["docker", "exec", "-i", self.container_name] + server_cmd,
+            self.timeout, self.max_output_chars,
         )
 
+    def close(self) -> None:
+        self._close_servers()
+        with self._lock:
+            if not self._started:
+                return
+            self._started = False
+        if self.pool is not None:
+            self.pool.release(self)
+        else:
+            _docker_rm(self.container_name)
+
 
-class SubprocessRunner:
+class SubprocessRunner(_ResidentServers):
     def __init__(
         self,
         workspace_dir: Path,
@@ -119,44 +631,59 @@ class SubprocessRunner:
         self.timeout = timeout
         self.max_output_chars = max_output_chars
 
+        self.startup_seconds = 0.0
+        self.exec_seconds = 0.0
+        self.exec_count = 0
+        self.output_bytes = 0      # bytes read from tool stdout/stderr
+        self.early_stops = 0       # tools killed once their output hit the limit
+        self._stats_lock = threading.Lock()
+        self.timer = PhaseTimer()
+        self._servers = {}
+        self._servers_lock = threading.Lock()
+
+    def _record(self, elapsed: float) -> None:
+        with self._stats_lock:
+            self.exec_seconds += elapsed
+            self.exec_count += 1
+        self.timer.add("sandbox_exec", elapsed)
+
+    def _record_output(self, result: RunResult) -> None:
+        with self._stats_lock:
+            self.output_bytes += result.output_bytes
+            self.early_stops += result.stopped_early
+
+    def stats(self) -> dict[str, float | int]:
+        return {
+            "startup_seconds": round(self.startup_seconds, 3),
+            "exec_seconds": round(self.exec_seconds, 3),
+            "exec_count": self.exec_count,
+            "output_bytes": self.output_bytes,
+            "early_stops": self.early_stops,
+        }
+
+    def _resident_server(self, server_cmd: list[str]) -> ResidentServer | None:
+        return ResidentServer(server_cmd, self.timeout, self.max_output_chars, cwd=str(self.workspace_dir))
+
+    def close(self) -> None:
+        self._close_servers()
+
     def run(self, command: list[str]) -> RunResult:
         log.debug("Subprocess command: %s", " ".join(command))
-        timed_out = False
+        start = time.monotonic()
         try:
-            proc = subprocess.run(
-                command,
-                capture_output=True,
-                text=True,
-                timeout=self.timeout,
-                cwd=str(self.workspace_dir),
-            )
-            stdout = proc.stdout
-            stderr = proc.stderr
-            returncode = proc.returncode
-        except subprocess.TimeoutExpired as e:
-            stdout = (e.stdout or b"").decode("utf-8", errors="replace")
-            stderr = (e.stderr or b"").decode("utf-8", errors="replace")
-            returncode = -1
-            timed_out = True
+            return self._run(command)
+        finally:
+            self._record(time.monotonic() - start)
+
+    def _run(self, command: list[str]) -> RunResult:
+        try:
+            result = _capture(command, self.timeout, self.max_output_chars, cwd=str(self.workspace_dir))
         except FileNotFoundError:
             return RunResult(
                 stdout="",
                 stderr=f"Command not found: {command[0]}",
                 returncode=127,
+                sandbox_failed=True,
             )
-
-        truncated = False
-        if len(stdout) > self.max_output_chars:
-            stdout = stdout[: self.max_output_chars] + "\n... [output truncated]"
-            truncated = True
-        if len(stderr) > self.max_output_chars:
-            stderr = stderr[: self.max_output_chars] + "\n... [output truncated]"
-            truncated = True
-
-        return RunResult(
-            stdout=stdout,
-            stderr=stderr,
-            returncode=returncode,
-            truncated=truncated,
-            timed_out=timed_out,
-        )
+        self._record_output(result)
+        return result
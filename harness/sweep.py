@@ -0,0 +1,214 @@
+from __future__ import annotations
+
+import dataclasses
+import json
+import logging
+import threading
+import time
+from datetime import datetime, timezone
+from pathlib import Path
+from typing import Any
+
+from .config import BenchmarkConfig
+from .langfuse import create_langfuse_client
+from .metrics import AggregateMetrics, TaskMetrics
+from .progress import ProgressBoard
+from .runner import (
+    TaskConfig,
+    _report_task_failure,
+    calls_summary,
+    load_tasks,
+    provider_slot,
+    run_single_task,
+    write_report,
+)
+from .sandbox import container_pool
+
+log = logging.getLogger(__name__)
+
+SWEEP_REPORT = "sweep_report.json"
+
+# Aggregate metrics copied into the comparison report per model
+_HEADLINE = (
+    "total_score", "main_score", "bonus_score", "success_rate", "tasks_run", "tasks_with_answer",
+    "avg_tool_calls_per_task", "avg_hallucination_rate", "total_wall_time", "total_tokens",
+    "tool_cache_hit_rate", "total_errors",
+)
+
+
+def parse_model_spec(spec: str) -> tuple[str, str]:
+    """Split "anthropic/claude-opus-4-6" at the first "/"; OpenRouter models keep theirs."""
+    provider, sep, model = spec.partition("/")
+    if not sep or not provider or not model:
+        raise ValueError(f"Expected PROVIDER/MODEL, got {spec!r}")
+    return provider, model
+
+
+def sweep_configs(base: BenchmarkConfig, specs: list[str], report_root: Path) -> list[BenchmarkConfig]:
+    """One config per PROVIDER/MODEL, each with its own <report_root>/<provider>_<model>."""
+    configs = []
+    for spec in specs:
+        provider, model = parse_model_spec(spec)
+        safe_model = model.replace("/", "_").replace(":", "_")
+        configs.append(dataclasses.replace(
+            base,
+            provider=provider,
+            model=model,
+            results_dir=report_root / f"{provider}_{safe_model}",
+            container_pool=True,
+            verbose=False,
+        ))
+    return configs
+
+
+def run_sweep(
+    configs: list[BenchmarkConfig],
+    task_filter: str | None,
+    report_root: Path,
+) -> list[tuple[BenchmarkConfig, AggregateMetrics]]:
+    """Run every (model, task) pair in one process and write per-model and comparison reports.
+
+    The pairs share one worker pool of --jobs threads, the process-wide HTTP
+    connection pools, rate limiters and per-provider slots, the tool-output
+    cache and (with --pooled-sandbox) the sandbox containers. A worker only
+    takes a pair whose provider has a free slot, so a saturated provider
+    does not hold up the others.
+    """
+    base = configs[0]
+    tasks = load_tasks(base.project_root / "tasks.json", base.project_root)
+    if task_filter:
+        tasks = [t for t in tasks if t.task_id == task_filter]
+        if not tasks:
+            raise ValueError(f"No task found matching {task_filter!r}")
+
+    # Task-major order: the first model to reach a binary fills the tool
+    # cache for the others
+    pairs = [(config, task) for task in tasks for config in configs]
+    jobs = max(1, base.jobs)
+    limit = base.provider_concurrency or jobs
+    slots = [provider_slot(config.provider, limit) for config, _ in pairs]
+
+    mode = "docker" if base.use_docker else "local"
+    if base.use_docker and base.pooled_sandbox:
+        mode = "docker (pooled, shared)"
+    print(f"\n{'='*60}")
+    print(f"  AgentRE-Bench sweep")
+    print(f"  {len(configs)} models x {len(tasks)} task{'s' if len(tasks) != 1 else ''} | {mode}")
+    print(f"  Jobs: {jobs} (max {limit} per provider)")
+    print(f"{'='*60}")
+    for config in configs:
+        print(f"  {config.provider}/{config.model} -> {config.results_dir}")
+
+    langfuse_client = create_langfuse_client(
+        public_key=base.langfuse_public_key,
+        secret_key=base.langfuse_secret_key,
+        host=base.langfuse_host,
+    )
+
+    width = len(str(len(pairs)))
+    board = ProgressBoard([
+        f"  [{i:>{width}}/{len(pairs)}] {config.provider}/{config.model} {task.task_id}"
+        for i, (config, task) in enumerate(pairs, 1)
+    ])
+    results: list[tuple[TaskMetrics, dict] | None] = [None] * len(pairs)
+    pending = list(range(len(pairs)))
+    ready = threading.Condition()
+
+    def next_pair() -> int | None:
+        with ready:
+            while pending:
+                for n, idx in enumerate(pending):
+                    if slots[idx].acquire(blocking=False):
+                        return pending.pop(n)
+                ready.wait()
+            return None
+
+    def worker() -> None:
+        while (idx := next_pair()) is not None:
+            config, task = pairs[idx]
+            board.start(idx)
+            try:
+                metrics, score = run_single_task(
+                    task, config, langfuse_client=langfuse_client,
+                    progress_callback=lambda: board.tick(idx),
+                )
+                results[idx] = (metrics, score)
+                board.finish(idx, f"{metrics.score:.4f}  ({calls_summary(metrics)}, "
+                                  f"{metrics.wall_time_seconds:.1f}s)")
+            except Exception as e:
+                _report_task_failure(task, config, langfuse_client, e)
+                board.finish(idx, "FAILED")
+            finally:
+                slots[idx].release()
+                with ready:
+                    ready.notify_all()
+
+    start = time.monotonic()
+    threads = [threading.Thread(target=worker, daemon=True) for _ in range(min(jobs, len(pairs)))]
+    try:
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    finally:
+        langfuse_client.shutdown()
+        container_pool.close()
+    elapsed = time.monotonic() - start
+
+    outcome = []
+    for config in configs:
+        done = [r for (c, _), r in zip(pairs, results) if c is config and r is not None]
+        aggregate, path = write_report(config, [m for m, _ in done], [s for _, s in done])
+        outcome.append((config, aggregate))
+    path = write_sweep_report(report_root, outcome, pairs, results, elapsed)
+    print_comparison(outcome)
+    print(f"\nSweep wall time: {elapsed:.1f}s (sum of task times: "
+          f"{sum(a.total_wall_time for _, a in outcome):.1f}s)")
+    print(f"Comparison report saved to {path}")
+    return outcome
+
+
+def write_sweep_report(
+    report_root: Path,
+    outcome: list[tuple[BenchmarkConfig, AggregateMetrics]],
+    pairs: list[tuple[BenchmarkConfig, TaskConfig]],
+    results: list[tuple[TaskMetrics, dict] | None],
+    elapsed: float,
+) -> Path:
+    """<report_root>/sweep_report.json: headline metrics per model and a task x model score table."""
+    label = {id(config): f"{config.provider}/{config.model}" for config, _ in outcome}
+    scores: dict[str, dict[str, Any]] = {}
+    for (config, task), result in zip(pairs, results):
+        scores.setdefault(task.task_id, {})[label[id(config)]] = result[0].score if result else None
+    report = {
+        "created": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+        "wall_time_seconds": round(elapsed, 2),
+        "models": [
+            {
+                "provider": config.provider,
+                "model": config.model,
+                "results_dir": str(config.results_dir),
+                "config_hash": config.fingerprint(),
+                **{key: value for key, value in aggregate.to_dict().items() if key in _HEADLINE},
+            }
+            for config, aggregate in outcome
+        ],
+        "task_scores": scores,
+    }
+    report_root.mkdir(parents=True, exist_ok=True)
+    path = report_root / SWEEP_REPORT
+    with open(path, "w") as f:
+        json.dump(report, f, indent=2)
+    return path
+
+
+def print_comparison(outcome: list[tuple[BenchmarkConfig, AggregateMetrics]]) -> None:
+    names = [f"{config.provider}/{config.model}" for config, _ in outcome]
+    width = max(24, *(len(n) for n in names))
+    print(f"\n{'Model':<{width}} {'Score':>7} {'Main':>7} {'Bonus':>6} {'Answered':>9} "
+          f"{'Calls':>6} {'Halluc':>7} {'Time':>8} {'Tokens':>10}")
+    print("-" * (width + 70))
+    for name, (_, a) in sorted(zip(names, outcome), key=lambda item: -item[1][1].total_score):
+        print(f"{name:<{width}} {a.total_score:7.4f} {a.main_score:7.4f} {a.bonus_score:6.2f} "
+              f"{a.tasks_with_answer:>4}/{a.tasks_run:<4} {a.avg_tool_calls_per_task:6.1f} "
+              f"{a.avg_hallucination_rate:7.3f} {a.total_wall_time:7.1f}s {a.total_tokens:>10,}")
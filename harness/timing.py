@@ -0,0 +1,96 @@
+from __future__ import annotations
+
+import math
+import threading
+import time
+from contextlib import contextmanager
+from typing import Any, Iterator
+
+# 10 µs resolution: index hits and no-op calls finish well under a millisecond
+SAMPLE_DIGITS = 5
+
+
+class PhaseTimer:
+    """Wall-clock samples per named phase ("llm", "sandbox_exec", ...).
+
+    Each component that does timed work owns one (the agent loop, the
+    provider, the tool executor, the sandbox runner) and the runner merges
+    them per task. Safe to record from several threads.
+    """
+
+    def __init__(self):
+        self.samples: dict[str, list[float]] = {}
+        self._lock = threading.Lock()
+
+    def add(self, phase: str, seconds: float) -> None:
+        with self._lock:
+            self.samples.setdefault(phase, []).append(round(seconds, SAMPLE_DIGITS))
+
+    @contextmanager
+    def phase(self, name: str) -> Iterator[None]:
+        start = time.monotonic()
+        try:
+            yield
+        finally:
+            self.add(name, time.monotonic() - start)
+
+    def snapshot(self) -> dict[str, list[float]]:
+        with self._lock:
+            return {phase: list(values) for phase, values in self.samples.items()}
+
+
+class TimedProxy:
+    """Forwards to `target`, recording every method call under `phase`.
+
+    Used for the Langfuse client and the transcript writer, whose calls are
+    scattered through the agent loop.
+    """
+
+    def __init__(self, target: Any, timer: PhaseTimer, phase: str):
+        self._target = target
+        self._timer = timer
+        self._phase = phase
+
+    def __getattr__(self, name: str) -> Any:
+        attr = getattr(self._target, name)
+        if not callable(attr):
+            return attr
+
+        def timed(*args, **kwargs):
+            with self._timer.phase(self._phase):
+                return attr(*args, **kwargs)
+        return timed
+
+
+def merge_samples(*sources: dict[str, list[float]]) -> dict[str, list[float]]:
+    merged: dict[str, list[float]] = {}
+    for source in sources:
+        for phase, values in source.items():
+            merged.setdefault(phase, []).extend(values)
+    return merged
+
+
+def percentile(ordered: list[float], q: float) -> float:
+    """Nearest-rank percentile of already sorted values (q in 0..100)."""
+    if not ordered:
+        return 0.0
+    rank = max(1, math.ceil(q / 100 * len(ordered)))
+    return ordered[rank - 1]
+
+
+def summarize(samples: dict[str, list[float]]) -> dict[str, dict[str, float | int]]:
+    """{phase: {count, total, p50, p95, p99, max}} in seconds, busiest phase first."""
+    summary = {}
+    for phase, values in samples.items():
+        if not values:
+            continue
+        ordered = sorted(values)
+        summary[phase] = {
+            "count": len(ordered),
+            "total": round(sum(ordered), SAMPLE_DIGITS),
+            "p50": percentile(ordered, 50),
+            "p95": percentile(ordered, 95),
+            "p99": percentile(ordered, 99),
+            "max": ordered[-1],
+        }
+    return dict(sorted(summary.items(), key=lambda item: -item[1]["total"]))
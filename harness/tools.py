@@ -1,14 +1,40 @@
 from __future__ import annotations
 
+import dataclasses
+import hashlib
+import json
 import logging
+import re
+import shutil
+import sys
+import threading
+import time
+from concurrent.futures import Future, ThreadPoolExecutor
+from contextlib import nullcontext
 from pathlib import Path
 from typing import Any
 
+from .cache import ToolOutputCache, file_sha256, single_flight
 from .config import BenchmarkConfig
-from .sandbox import DockerRunner, PathValidator, RunResult, SubprocessRunner
+from .index import ANALYZER, ANALYZER_SCRIPT, ENTROPY_HELPER, BinaryIndex, stored_result, tool_environment
+from .paging import OutputPager, StoredOutput, grep_lines
+from .sandbox import (
+    DockerRunner,
+    PathValidator,
+    PooledDockerRunner,
+    RunResult,
+    SubprocessRunner,
+    _truncate,
+    container_pool,
+)
+from .timing import PhaseTimer, merge_samples
 
 log = logging.getLogger(__name__)
 
+DISASM_DEFAULT_LENGTH = 256
+_SYMBOL_RE = re.compile(r"^[A-Za-z_.$][\w.$@]*$")
+_FILE_FORMAT_RE = re.compile(r"^\S.*:\s+file format \S+$")
+
 # ── Anthropic-native tool schemas (canonical format) ──────────────────
 
 TOOL_SCHEMAS = [
@@ -47,6 +73,46 @@ TOOL_SCHEMAS = [
             "required": ["path"],
         },
     },
+    {
+        "name": "section_strings",
+        "description": (
+            "Extract ASCII and UTF-16LE strings in one pass, each with its file "
+            "offset, virtual address and the ELF/PE/Mach-O section it lives in. "
+            "Starts with a per-section count; repeats are listed once with a "
+            "count. Filter by section to skip e.g. symbol-table noise."
+        ),
+        "input_schema": {
+            "type": "object",
+            "properties": {
+                "path": {
+                    "type": "string",
+                    "description": "Path to the binary file.",
+                },
+                "sections": {
+                    "type": "array",
+                    "items": {"type": "string"},
+                    "description": (
+                        "Only strings in these sections (e.g. [\".rodata\", \".data\"]; "
+                        "__TEXT,__cstring for Mach-O)."
+                    ),
+                },
+                "min_length": {
+                    "type": "integer",
+                    "description": "Minimum string length (default 4).",
+                },
+                "encoding": {
+                    "type": "string",
+                    "enum": ["ascii", "utf16", "both"],
+                    "description": "String encodings to extract (default both).",
+                },
+                "dedupe": {
+                    "type": "boolean",
+                    "description": "List repeated strings once (default true).",
+                },
+            },
+            "required": ["path"],
+        },
+    },
     {
         "name": "readelf",
         "description": (
@@ -101,6 +167,40 @@ TOOL_SCHEMAS = [
             "required": ["path", "flags"],
         },
     },
+    {
+        "name": "disasm",
+        "description": (
+            "Disassemble one function by symbol name, or an address range, instead of "
+            "the whole binary. Call and jump targets are shown with their symbol names. "
+            "Give either `symbol`, or `start_address` plus `end_address` or `length`."
+        ),
+        "input_schema": {
+            "type": "object",
+            "properties": {
+                "path": {
+                    "type": "string",
+                    "description": "Path to the binary.",
+                },
+                "symbol": {
+                    "type": "string",
+                    "description": "Function to disassemble (e.g. main).",
+                },
+                "start_address": {
+                    "type": "string",
+                    "description": "First virtual address, in hex (e.g. 0x401615).",
+                },
+                "end_address": {
+                    "type": "string",
+                    "description": "Address to stop before, in hex.",
+                },
+                "length": {
+                    "type": "integer",
+                    "description": f"Bytes from start_address (default {DISASM_DEFAULT_LENGTH}).",
+                },
+            },
+            "required": ["path"],
+        },
+    },
     {
         "name": "nm",
         "description": "List symbols from an object file or binary.",
@@ -171,7 +271,8 @@ TOOL_SCHEMAS = [
             "Compute Shannon entropy (0.0-8.0) over a sliding window. "
             "High entropy (>7.0) indicates encrypted or compressed data. "
             "Low entropy (<4.0) indicates plaintext or sparse data. "
-            "Optionally target a specific ELF section."
+            "Optionally target a specific section, or get a per-section "
+            "entropy table for every ELF/PE/Mach-O section at once."
         ),
         "input_schema": {
             "type": "object",
@@ -182,12 +283,26 @@ TOOL_SCHEMAS = [
                 },
                 "section": {
                     "type": "string",
-                    "description": "Optional ELF section name (e.g. .text, .rodata, .data).",
+                    "description": (
+                        "Optional section name (e.g. .text, .rodata, .data; "
+                        "__TEXT,__cstring for Mach-O)."
+                    ),
                 },
                 "window_size": {
                     "type": "integer",
                     "description": "Sliding window size in bytes (default 256).",
                 },
+                "step": {
+                    "type": "integer",
+                    "description": (
+                        "Bytes between window starts (default: window_size, "
+                        "i.e. non-overlapping). Smaller values give overlapping windows."
+                    ),
+                },
+                "per_section": {
+                    "type": "boolean",
+                    "description": "Report one entropy value per section instead of windows.",
+                },
             },
             "required": ["path"],
         },
@@ -267,101 +382,89 @@ TOOL_SCHEMAS = [
 ]
 
 
-# ── Entropy computation script (runs inside sandbox via python3 -c) ───
+# Offered only with paged output (--paged-output); they read outputs the
+# executor already holds and never start a process.
+PAGING_TOOL_SCHEMAS = [
+    {
+        "name": "read_more",
+        "description": (
+            "Read another page of a large tool output that was split into pages. "
+            "Use the cursor shown at the end of the first page. Cheaper than "
+            "re-running the command."
+        ),
+        "input_schema": {
+            "type": "object",
+            "properties": {
+                "cursor": {
+                    "type": "string",
+                    "description": "Cursor of the paged output (e.g. 'out1').",
+                },
+                "page": {
+                    "type": "integer",
+                    "description": "Page number to read (1-based). Default: the next unread page.",
+                },
+            },
+            "required": ["cursor"],
+        },
+    },
+    {
+        "name": "grep_output",
+        "description": (
+            "Search a large paged tool output for lines matching a regular "
+            "expression, without re-running the command. Returns matching lines "
+            "with their line numbers."
+        ),
+        "input_schema": {
+            "type": "object",
+            "properties": {
+                "cursor": {
+                    "type": "string",
+                    "description": "Cursor of the paged output (e.g. 'out1').",
+                },
+                "pattern": {
+                    "type": "string",
+                    "description": "Regular expression (Python syntax) to search for.",
+                },
+                "context": {
+                    "type": "integer",
+                    "description": "Lines of context before and after each match (0-5, default 0).",
+                },
+                "max_matches": {
+                    "type": "integer",
+                    "description": "Maximum matches to return (default 50).",
+                },
+            },
+            "required": ["cursor", "pattern"],
+        },
+    },
+]
 
-ENTROPY_SCRIPT = r'''
-import math, struct, sys, os
+PAGING_TOOLS = {s["name"] for s in PAGING_TOOL_SCHEMAS}
+
+
+# ── Analysis helpers ──────────────────────────────────────────────────
+
+PEFILE_FLAGS = ("headers", "sections", "imports", "exports", "resources", "all")
+STRING_ENCODINGS = ("ascii", "utf16", "both")
+
+
+# Inspections almost every transcript opens with. --prefetch runs those the
+# binary's format offers while the first model turn is in flight.
+PREFETCH_DEFAULT = ("file", "readelf:-h", "readelf:-S", "strings", "nm", "pefile:headers", "pefile:imports")
+PREFETCH_WORKERS = 2
 
-def entropy(data, window=256):
-    results = []
-    for i in range(0, len(data), window):
-        chunk = data[i:i+window]
-        if len(chunk) < 16:
-            break
-        freq = [0]*256
-        for b in chunk:
-            freq[b] += 1
-        n = len(chunk)
-        ent = 0.0
-        for f in freq:
-            if f > 0:
-                p = f / n
-                ent -= p * math.log2(p)
-        results.append((i, len(chunk), round(ent, 4)))
-    return results
-
-path = sys.argv[1]
-section = sys.argv[2] if len(sys.argv) > 2 and sys.argv[2] != "" else None
-window = int(sys.argv[3]) if len(sys.argv) > 3 else 256
-
-with open(path, "rb") as f:
-    data = f.read()
-
-if section:
-    # Parse ELF section headers to find the section
-    if data[:4] != b"\x7fELF":
-        print(f"Error: not an ELF file", file=sys.stderr)
-        sys.exit(1)
-    is_64 = data[4] == 2
-    if is_64:
-        e_shoff = struct.unpack_from("<Q", data, 40)[0]
-        e_shentsize = struct.unpack_from("<H", data, 58)[0]
-        e_shnum = struct.unpack_from("<H", data, 60)[0]
-        e_shstrndx = struct.unpack_from("<H", data, 62)[0]
-        # Get section name string table
-        str_sh_off = e_shoff + e_shstrndx * e_shentsize
-        str_sh_offset = struct.unpack_from("<Q", data, str_sh_off + 24)[0]
-        str_sh_size = struct.unpack_from("<Q", data, str_sh_off + 32)[0]
-        strtab = data[str_sh_offset:str_sh_offset+str_sh_size]
-        found = False
-        for i in range(e_shnum):
-            off = e_shoff + i * e_shentsize
-            sh_name_idx = struct.unpack_from("<I", data, off)[0]
-            name = strtab[sh_name_idx:].split(b"\x00")[0].decode("ascii", errors="replace")
-            if name == section:
-                sh_offset = struct.unpack_from("<Q", data, off + 24)[0]
-                sh_size = struct.unpack_from("<Q", data, off + 32)[0]
-                data = data[sh_offset:sh_offset+sh_size]
-                found = True
-                break
-        if not found:
-            print(f"Section {section!r} not found", file=sys.stderr)
-            sys.exit(1)
-    else:
-        print("Only ELF64 supported for section targeting", file=sys.stderr)
-        sys.exit(1)
-
-results = entropy(data, window)
-total_ent = 0.0
-if data:
-    freq = [0]*256
-    for b in data:
-        freq[b] += 1
-    n = len(data)
-    for f in freq:
-        if f > 0:
-            p = f / n
-            total_ent -= p * math.log2(p)
-
-print(f"Total size: {len(data)} bytes")
-print(f"Overall entropy: {total_ent:.4f} bits/byte")
-print(f"Window size: {window} bytes")
-print(f"Windows analyzed: {len(results)}")
-print()
-if results:
-    ents = [r[2] for r in results]
-    print(f"Min window entropy: {min(ents):.4f}")
-    print(f"Max window entropy: {max(ents):.4f}")
-    print(f"Avg window entropy: {sum(ents)/len(ents):.4f}")
-    print()
-    print("Offset      Size  Entropy")
-    print("-" * 35)
-    for offset, size, ent in results[:50]:
-        bar = "#" * int(ent * 4)
-        print(f"0x{offset:08x}  {size:4d}  {ent:.4f}  {bar}")
-    if len(results) > 50:
-        print(f"... ({len(results) - 50} more windows)")
-'''
+
+def parse_prefetch_spec(spec: str) -> tuple[str, dict[str, Any]]:
+    """"readelf:-S" -> ("readelf", {"flags": "-S"}); a bare name prefetches the tool's defaults."""
+    tool, sep, flags = spec.partition(":")
+    schema = next((s for s in TOOL_SCHEMAS if s["name"] == tool and tool != "final_answer"), None)
+    if schema is None:
+        raise ValueError(f"Cannot prefetch {spec!r}: unknown tool {tool!r}")
+    if not sep:
+        return tool, {}
+    if "flags" not in schema["input_schema"]["properties"]:
+        raise ValueError(f"Cannot prefetch {spec!r}: {tool} takes no flags")
+    return tool, {"flags": flags}
 
 
 # ── Tool execution ────────────────────────────────────────────────────
@@ -372,21 +475,109 @@ class ToolExecutor:
         self.binary_path = binary_path.resolve()
         self.validator = PathValidator(config.workspace_dir)
 
-        if config.use_docker:
+        # With paged output the whole result (up to a store limit) is captured
+        # once and handed to the model a page of max_output_chars at a time.
+        # A token budget implies it: outputs the context has no room for are held.
+        self.pager: OutputPager | None = None
+        self.capture_chars = config.max_output_chars
+        if config.paged_output or config.token_budgeted:
+            self.pager = OutputPager(config.max_output_chars)
+            self.capture_chars = max(config.paged_output_max_chars, config.max_output_chars)
+        self.paged_outputs = 0
+        self.page_requests = 0
+        self.page_reruns_avoided = 0
+        self.held_outputs = 0
+        self.held_chars = 0
+
+        # Background runs started by prefetch(), by command, until a matching call takes one
+        self._prefetched: dict[str, Future] = {}
+        self._prefetch_pool: ThreadPoolExecutor | None = None
+        self.prefetch_runs = 0
+        self.prefetch_hits = 0
+        self.prefetch_saved_seconds = 0.0
+
+        if config.use_docker and config.pooled_sandbox:
+            self.runner = PooledDockerRunner(
+                image=config.docker_image,
+                workspace_dir=config.workspace_dir,
+                timeout=config.tool_timeout_seconds,
+                max_output_chars=self.capture_chars,
+                pool=container_pool if config.container_pool else None,
+            )
+        elif config.use_docker:
             self.runner = DockerRunner(
                 image=config.docker_image,
                 workspace_dir=config.workspace_dir,
                 timeout=config.tool_timeout_seconds,
-                max_output_chars=config.max_output_chars,
+                max_output_chars=self.capture_chars,
             )
         else:
             self.runner = SubprocessRunner(
                 workspace_dir=config.workspace_dir,
                 timeout=config.tool_timeout_seconds,
-                max_output_chars=config.max_output_chars,
+                max_output_chars=self.capture_chars,
             )
 
-    def _resolve_path(self, path_arg: str) -> str:
+        self.cache: ToolOutputCache | None = None
+        if config.tool_cache_enabled:
+            self.cache = ToolOutputCache(config.tool_cache_dir, config.tool_cache_max_bytes)
+        self.cache_hits = 0
+        self.cache_misses = 0
+        self._stats_lock = threading.Lock()   # execute() may be called from several threads
+        self.timer = PhaseTimer()
+
+        # Identity of the installed tools; keys the index and the tool-output cache
+        self.environment = ""
+        if config.binary_index_enabled or self.cache is not None:
+            self.environment = tool_environment(config.use_docker, config.docker_image)
+
+        # Build-time pre-analysis of the task binary; None if missing or stale
+        self.index: BinaryIndex | None = None
+        if config.binary_index_enabled:
+            self.index = BinaryIndex.open(self.binary_path, self.environment)
+        self.index_hits = 0
+
+        if config.use_docker or shutil.which(ANALYZER):
+            self.analyzer = [ANALYZER]
+        else:
+            self.analyzer = [sys.executable, str(ANALYZER_SCRIPT)]
+
+    def sandbox_stats(self) -> dict[str, Any]:
+        stats = self.runner.stats()
+        stats["pooled"] = isinstance(self.runner, PooledDockerRunner)
+        return stats
+
+    def phase_samples(self) -> dict[str, list[float]]:
+        """Index/cache lookups plus the sandbox runner's own startup and exec samples."""
+        return merge_samples(self.timer.snapshot(), self.runner.timer.snapshot())
+
+    def tool_cache_stats(self) -> dict[str, Any]:
+        return {
+            "enabled": self.cache is not None,
+            "hits": self.cache_hits,
+            "misses": self.cache_misses,
+            "index_loaded": self.index is not None,
+            "index_hits": self.index_hits,
+            "paged_outputs": self.paged_outputs,
+            "page_requests": self.page_requests,
+            "page_reruns_avoided": self.page_reruns_avoided,
+            "held_outputs": self.held_outputs,
+            "held_chars": self.held_chars,
+            "prefetch_runs": self.prefetch_runs,
+            "prefetch_hits": self.prefetch_hits,
+            "prefetch_saved_seconds": round(self.prefetch_saved_seconds, 3),
+        }
+
+    def close(self) -> None:
+        """Release sandbox resources (tears down the pooled container)."""
+        if self._prefetch_pool is not None:
+            self._prefetch_pool.shutdown(wait=True, cancel_futures=True)
+        self.runner.close()
+        if self.index is not None:
+            self.index.close()
+            self.index = None
+
+    def _validate_path(self, path_arg: str) -> Path:
         # The agent may send paths like "/workspace/binary" (Docker-style)
         # or just "binary". Strip the /workspace/ prefix before validating
         # against the real workspace directory.
@@ -396,7 +587,10 @@ class ToolExecutor:
         elif clean.startswith("/workspace"):
             clean = clean[len("/workspace"):]
 
-        validated = self.validator.validate(clean)
+        return self.validator.validate(clean)
+
+    def _resolve_path(self, path_arg: str) -> str:
+        validated = self._validate_path(path_arg)
         if self.config.use_docker:
             return "/workspace/" + str(validated.relative_to(self.config.workspace_dir))
         return str(validated)
@@ -405,6 +599,9 @@ class ToolExecutor:
         if tool_name == "final_answer":
             return {"is_final_answer": True, "answer": tool_input}
 
+        if tool_name in PAGING_TOOLS and self.pager is not None:
+            return self._paging_tool(tool_name, tool_input)
+
         if tool_name not in self.config.allowed_tools:
             return {
                 "is_final_answer": False,
@@ -416,8 +613,262 @@ class ToolExecutor:
         except (ValueError, FileNotFoundError) as e:
             return {"is_final_answer": False, "error": str(e)}
 
-        result = self.runner.run(cmd)
-        return self._format_result(result)
+        if self.pager is not None:
+            # The same command again: serve the held output instead of re-running it
+            stored = self.pager.lookup_command(json.dumps(cmd))
+            if stored is not None:
+                with self._stats_lock:
+                    self.page_reruns_avoided += 1
+                return self._format_page(stored, 0)
+
+        if self.index is not None and self._validate_path(tool_input.get("path", "")) == self.binary_path:
+            sandbox_path = self._resolve_path(tool_input.get("path", ""))
+            with self.timer.phase("tool_index"):
+                if tool_name == "disasm" and tool_input.get("symbol"):
+                    indexed = self._indexed_function(str(tool_input["symbol"]), sandbox_path)
+                else:
+                    indexed = self.index.lookup(
+                        self._normalize_command(cmd, sandbox_path), sandbox_path, self.capture_chars,
+                    )
+            if indexed is not None:
+                with self._stats_lock:
+                    self.index_hits += 1
+                return self._finish(tool_name, cmd, indexed)
+
+        prefetched = self._take_prefetched(cmd)
+        if prefetched is not None:
+            return self._finish(tool_name, cmd, prefetched)
+
+        cache_key = self._cache_key(tool_name, tool_input, cmd)
+        if cache_key is None:
+            return self._finish(tool_name, cmd, self._run(cmd))
+        with single_flight(cache_key):
+            with self.timer.phase("tool_cache"):
+                cached = self.cache.get(cache_key)
+            with self._stats_lock:
+                if cached is not None:
+                    self.cache_hits += 1
+                else:
+                    self.cache_misses += 1
+            if cached is None:
+                cached = self._run(cmd)
+                with self.timer.phase("tool_cache_store"):
+                    self.cache.put(cache_key, cached)
+        return self._finish(tool_name, cmd, cached)
+
+    def prefetch(self, specs: list[str], file_type: str) -> None:
+        """Start common inspections in the background, before the model asks for them.
+
+        Only tools offered for `file_type` are run, with the task binary as
+        the path, so the commands match what the model would send. Ones the
+        index or the tool-output cache already answer are skipped. A result
+        is stored in the cache and handed to the first matching execute();
+        nothing reaches the model unless it asks.
+        """
+        offered = {s["name"] for s in get_tool_schemas_for_format(file_type, include_final_answer=False)}
+        path = str(self.binary_path.relative_to(self.config.workspace_dir))
+        for spec in specs:
+            tool, args = parse_prefetch_spec(spec)
+            if tool not in offered or tool not in self.config.allowed_tools:
+                continue
+            tool_input = {"path": path, **args}
+            try:
+                cmd = self._build_command(tool, tool_input)
+            except (ValueError, FileNotFoundError):
+                continue
+            key = json.dumps(cmd)
+            if key in self._prefetched:
+                continue
+            if self._prefetch_pool is None:
+                self._prefetch_pool = ThreadPoolExecutor(max_workers=PREFETCH_WORKERS, thread_name_prefix="prefetch")
+            self._prefetched[key] = self._prefetch_pool.submit(self._prefetch_run, tool, tool_input, cmd)
+
+    def _prefetch_run(self, tool_name: str, tool_input: dict[str, Any], cmd: list[str]) -> tuple[RunResult, float] | None:
+        """(result, seconds it took), or None when the index or cache will answer the call anyway."""
+        if self.index is not None:
+            sandbox_path = self._resolve_path(tool_input["path"])
+            if self.index.lookup(self._normalize_command(cmd, sandbox_path), sandbox_path, self.capture_chars):
+                return None
+        cache_key = self._cache_key(tool_name, tool_input, cmd)
+        with single_flight(cache_key) if cache_key is not None else nullcontext():
+            if cache_key is not None and self.cache.get(cache_key) is not None:
+                return None
+            started = time.monotonic()
+            with self.timer.phase("tool_prefetch"):
+                result = self._run(cmd)
+            seconds = time.monotonic() - started
+            if cache_key is not None:
+                self.cache.put(cache_key, result)
+        with self._stats_lock:
+            self.prefetch_runs += 1
+        return result, seconds
+
+    def _take_prefetched(self, cmd: list[str]) -> RunResult | None:
+        """The prefetched result for `cmd`, waiting for it if still running; each is used once."""
+        with self._stats_lock:
+            future = self._prefetched.pop(json.dumps(cmd), None)
+        if future is None:
+            return None
+        started = time.monotonic()
+        try:
+            with self.timer.phase("tool_prefetch_wait"):
+                outcome = future.result()
+        except Exception as e:
+            log.warning("Prefetch of %s failed: %s", cmd[0], e)
+            return None
+        if outcome is None:
+            return None
+        result, seconds = outcome
+        with self._stats_lock:
+            self.prefetch_hits += 1
+            self.prefetch_saved_seconds += max(0.0, seconds - (time.monotonic() - started))
+        return result
+
+    def _run(self, cmd: list[str]) -> RunResult:
+        """Run a built command: on the resident analysis server if it handles it, else the runner."""
+        if self.config.analysis_server:
+            if cmd[0] == ENTROPY_HELPER:
+                request = ["entropy", *cmd[1:]]
+            elif cmd[:len(self.analyzer)] == self.analyzer:
+                request = cmd[len(self.analyzer):]
+            else:
+                request = None
+            if request is not None:
+                result = self.runner.serve(self.analyzer + ["--serve"], request)
+                if result is not None:
+                    return result
+        return self.runner.run(cmd)
+
+    def _indexed_function(self, symbol: str, sandbox_path: str) -> RunResult | None:
+        """disasm of one function, sliced from the index's full disassembly."""
+        text = self.index.function_disassembly(symbol, sandbox_path)
+        if text is None:
+            return None  # not a function start objdump labelled; let objdump decide
+        return stored_result(text.encode("utf-8"), b"", 0, self.capture_chars)
+
+    def _finish(self, tool_name: str, cmd: list[str], result: RunResult) -> dict[str, Any]:
+        if tool_name == "disasm":
+            result = dataclasses.replace(result, stdout=trim_disassembly(result.stdout) or (
+                "(no code disassembled: unknown symbol or no code in range; list symbols with nm)"
+                if result.returncode == 0 and not result.stderr else ""
+            ))
+        if self.pager is None:
+            return self._format_result(result)
+        if not self.pager.needs_paging(result.stdout):
+            if len(result.stderr) > self.config.max_output_chars:
+                stderr, _ = _truncate(result.stderr, self.config.max_output_chars)
+                result = dataclasses.replace(result, stderr=stderr, truncated=True)
+            return self._format_result(result)
+
+        stored = self.pager.store(json.dumps(cmd), result.stdout, complete=not result.stopped_early)
+        with self._stats_lock:
+            self.paged_outputs += 1
+        return self._format_page(stored, 0, result)
+
+    def _format_page(self, stored: StoredOutput, index: int, first: RunResult | None = None) -> dict[str, Any]:
+        """One page of a held output, with a footer telling the model how to get the rest."""
+        stored.next_page = index + 1
+        page = stored.page(index)
+        if first is not None:
+            stderr, _ = _truncate(first.stderr, self.config.max_output_chars)
+            formatted = self._format_result(dataclasses.replace(first, stdout=page, stderr=stderr, truncated=False))
+        else:
+            formatted = self._format_result(RunResult(stdout=page, stderr="", returncode=0))
+
+        footer = f"[page {index + 1}/{stored.pages} of {stored.cursor}, {len(stored.text):,} chars"
+        if not stored.complete:
+            footer += f"; capture stopped at {len(stored.text):,} chars"
+        if index + 1 < stored.pages:
+            footer += f'; read_more(cursor="{stored.cursor}") for page {index + 2}'
+        else:
+            footer += "; end of output"
+        footer += f'; grep_output(cursor="{stored.cursor}", pattern=...) to search]'
+
+        formatted["output"] = f"{formatted['output']}\n{footer}"
+        formatted["truncated"] = False
+        formatted["cursor"] = stored.cursor
+        formatted["page"] = index + 1
+        formatted["pages"] = stored.pages
+        return formatted
+
+    def hold_output(self, text: str, max_chars: int) -> str:
+        """Hold a tool result the context has no room for; returns what to send instead.
+
+        The full text goes to the pager in pages of `max_chars`, so read_more
+        serves it in pieces of the size that fitted, and the model gets the
+        first page with a footer naming the cursor.
+        """
+        key = json.dumps(["held", max_chars, hashlib.sha256(text.encode("utf-8", "replace")).hexdigest()])
+        stored = self.pager.store(key, text, complete=True, page_chars=max_chars)
+        stored.next_page = 1
+        with self._stats_lock:
+            self.held_outputs += 1
+            self.held_chars += len(text) - len(stored.page(0))
+        footer = f"[held to fit the context budget: page 1/{stored.pages} of {stored.cursor}, {len(text):,} chars"
+        if stored.pages > 1:
+            footer += f'; read_more(cursor="{stored.cursor}") for page 2'
+        footer += f'; grep_output(cursor="{stored.cursor}", pattern=...) to search]'
+        return f"{stored.page(0)}\n{footer}"
+
+    def _paging_tool(self, tool_name: str, args: dict[str, Any]) -> dict[str, Any]:
+        with self._stats_lock:
+            self.page_requests += 1
+        cursor = str(args.get("cursor", ""))
+        stored = self.pager.get(cursor)
+        if stored is None:
+            return {"is_final_answer": False, "error": f"Unknown or expired cursor: {cursor!r}"}
+
+        if tool_name == "read_more":
+            page = args.get("page")
+            index = int(page) - 1 if page is not None else stored.next_page
+            if not 0 <= index < stored.pages:
+                return {
+                    "is_final_answer": False,
+                    "error": f"{cursor} has pages 1-{stored.pages}" + (
+                        "; all pages have been read" if page is None else ""
+                    ),
+                }
+            return self._format_page(stored, index)
+
+        pattern = str(args.get("pattern", ""))
+        if not pattern:
+            return {"is_final_answer": False, "error": "grep_output needs a pattern"}
+        context = min(max(int(args.get("context", 0)), 0), 5)
+        max_matches = max(int(args.get("max_matches", 50)), 1)
+        text, total = grep_lines(stored.text, pattern, context, max_matches, self.config.max_output_chars)
+        header = f"{total} matching line{'s' if total != 1 else ''} in {cursor}"
+        if total > max_matches:
+            header += f" (first {max_matches} shown)"
+        return {
+            "is_final_answer": False,
+            "output": f"{header}\n{text}" if text else header,
+            "returncode": 0,
+            "timed_out": False,
+            "truncated": False,
+            "output_bytes": len(text),
+            "cursor": cursor,
+        }
+
+    def _cache_key(self, tool_name: str, tool_input: dict[str, Any], cmd: list[str]) -> str | None:
+        if self.cache is None:
+            return None
+        host_path = self._validate_path(tool_input.get("path", ""))
+        if not host_path.is_file():
+            return None
+        # Normalize the command: the binary is identified by content hash, so
+        # the path (host or /workspace) must not leak into the key.
+        normalized = self._normalize_command(cmd, self._resolve_path(tool_input.get("path", "")))
+        return self.cache.make_key(
+            file_sha256(host_path),
+            tool_name,
+            normalized,
+            self.environment,
+            self.capture_chars,
+        )
+
+    @staticmethod
+    def _normalize_command(cmd: list[str], sandbox_path: str) -> list[str]:
+        return [arg.replace(sandbox_path, "<binary>") for arg in cmd]
 
     def _build_command(self, tool_name: str, args: dict[str, Any]) -> list[str]:
         path = self._resolve_path(args.get("path", ""))
@@ -433,6 +884,27 @@ class ToolExecutor:
             cmd.append(path)
             return cmd
 
+        if tool_name == "section_strings":
+            cmd = self.analyzer + ["strings"]
+            ml = args.get("min_length")
+            if ml is not None:
+                if int(ml) < 1:
+                    raise ValueError(f"Invalid min_length: {ml}")
+                cmd += ["-n", str(int(ml))]
+            encoding = args.get("encoding", "both")
+            if encoding not in STRING_ENCODINGS:
+                raise ValueError(f"Invalid encoding: {encoding!r}")
+            cmd += ["-e", encoding]
+            sections = args.get("sections") or []
+            if isinstance(sections, str):
+                sections = [sections]
+            for section in sections:
+                cmd += ["-j", str(section)]
+            if not args.get("dedupe", True):
+                cmd.append("-D")
+            cmd.append(path)
+            return cmd
+
         if tool_name == "readelf":
             flags = args.get("flags", "-h")
             if flags not in ("-h", "-S", "-s", "-l", "-d", "-a"):
@@ -450,6 +922,26 @@ class ToolExecutor:
             cmd.append(path)
             return cmd
 
+        if tool_name == "disasm":
+            symbol = args.get("symbol")
+            start = args.get("start_address")
+            if symbol and start is not None:
+                raise ValueError("disasm takes either symbol or start_address, not both")
+            if symbol:
+                if not _SYMBOL_RE.match(str(symbol)):
+                    raise ValueError(f"Invalid symbol name: {symbol!r}")
+                return ["objdump", "-d", f"--disassemble={symbol}", path]
+            if start is None:
+                raise ValueError("disasm needs a symbol or a start_address")
+            start = _parse_address(start)
+            if args.get("end_address") is not None:
+                stop = _parse_address(args["end_address"])
+            else:
+                stop = start + int(args.get("length", DISASM_DEFAULT_LENGTH))
+            if stop <= start:
+                raise ValueError(f"Empty address range 0x{start:x}-0x{stop:x}")
+            return ["objdump", "-d", f"--start-address=0x{start:x}", f"--stop-address=0x{stop:x}", path]
+
         if tool_name == "nm":
             return ["nm", path]
 
@@ -464,67 +956,39 @@ class ToolExecutor:
             return ["xxd", "-s", str(int(offset)), "-l", str(length), path]
 
         if tool_name == "entropy":
-            section = args.get("section", "")
-            window = str(args.get("window_size", 256))
-            return [
-                "python3", "-c", ENTROPY_SCRIPT,
-                path, section, window,
-            ]
+            section = str(args.get("section") or "")
+            window = int(args.get("window_size", 256))
+            if window <= 0:
+                raise ValueError(f"Invalid window_size: {window}")
+            step = args.get("step")
+            per_section = bool(args.get("per_section", False))
 
-        if tool_name == "pefile":
-            flags = args.get("flags", "headers")
+            if self.config.use_docker or shutil.which(ENTROPY_HELPER):
+                cmd = [ENTROPY_HELPER, "-w", str(window)]
+                if step is not None:
+                    cmd += ["-s", str(int(step))]
+                if section:
+                    cmd += ["-j", section]
+                if per_section:
+                    cmd.append("-S")
+                cmd.append(path)
+                return cmd
 
-            # Python script that uses pefile library
-            pefile_script = f"""
-import pefile
-import sys
+            cmd = self.analyzer + ["entropy", "-w", str(window)]
+            if step is not None:
+                cmd += ["-s", str(int(step))]
+            if section:
+                cmd += ["-j", section]
+            if per_section:
+                cmd.append("-S")
+            cmd.append(path)
+            return cmd
 
-try:
-    pe = pefile.PE('{path}')
-
-    if '{flags}' == 'headers' or '{flags}' == 'all':
-        print("=== DOS HEADER ===")
-        print(pe.DOS_HEADER)
-        print("\\n=== NT HEADERS ===")
-        print(pe.NT_HEADERS)
-        print("\\n=== OPTIONAL HEADER ===")
-        print(pe.OPTIONAL_HEADER)
-
-    if '{flags}' == 'sections' or '{flags}' == 'all':
-        print("\\n=== SECTIONS ===")
-        for section in pe.sections:
-            print(f"{{section.Name.decode().rstrip(chr(0))}}:")
-            print(f"  Virtual Address: 0x{{section.VirtualAddress:x}}")
-            print(f"  Virtual Size: 0x{{section.Misc_VirtualSize:x}}")
-            print(f"  Raw Size: 0x{{section.SizeOfRawData:x}}")
-            print(f"  Characteristics: 0x{{section.Characteristics:x}}")
-
-    if '{flags}' == 'imports' or '{flags}' == 'all':
-        print("\\n=== IMPORTS ===")
-        if hasattr(pe, 'DIRECTORY_ENTRY_IMPORT'):
-            for entry in pe.DIRECTORY_ENTRY_IMPORT:
-                print(f"{{entry.dll.decode()}}:")
-                for imp in entry.imports:
-                    if imp.name:
-                        print(f"  {{imp.name.decode()}}")
-
-    if '{flags}' == 'exports' or '{flags}' == 'all':
-        print("\\n=== EXPORTS ===")
-        if hasattr(pe, 'DIRECTORY_ENTRY_EXPORT'):
-            for exp in pe.DIRECTORY_ENTRY_EXPORT.symbols:
-                print(f"  {{exp.name.decode() if exp.name else 'ordinal=' + str(exp.ordinal)}}")
-
-    if '{flags}' == 'resources' or '{flags}' == 'all':
-        print("\\n=== RESOURCES ===")
-        if hasattr(pe, 'DIRECTORY_ENTRY_RESOURCE'):
-            print("Resource directory present")
-
-    pe.close()
-except Exception as e:
-    print(f"Error: {{str(e)}}", file=sys.stderr)
-    sys.exit(1)
-"""
-            return ["python3", "-c", pefile_script]
+        if tool_name == "pefile":
+            flags = args.get("flags", "headers")
+            if flags not in PEFILE_FLAGS:
+                raise ValueError(f"Invalid pefile flags: {flags!r}")
+            return self.analyzer + ["pefile", flags, path]
 
         raise ValueError(f"Unknown tool: {tool_name!r}")
 
@@ -547,34 +1011,83 @@ except Exception as e:
             "returncode": result.returncode,
             "timed_out": result.timed_out,
             "truncated": result.truncated,
+            "output_bytes": result.output_bytes,
         }
 
 
+def _parse_address(value: Any) -> int:
+    """An address given as an integer or a hex string, with or without 0x."""
+    if isinstance(value, int):
+        address = value
+    else:
+        text = str(value).strip().lower()
+        try:
+            address = int(text[2:] if text.startswith("0x") else text, 16)
+        except ValueError:
+            raise ValueError(f"Invalid address: {value!r}") from None
+    if address < 0:
+        raise ValueError(f"Invalid address: {value!r}")
+    return address
+
+
+def trim_disassembly(text: str) -> str:
+    """objdump -d output without the file-format preamble and empty sections.
+
+    The first section heading is dropped as well; later ones are kept to mark
+    where a range crosses into another section.
+    """
+    out: list[str] = []
+    pending = None
+    for line in text.splitlines():
+        if not out and pending is None and _FILE_FORMAT_RE.match(line):
+            continue
+        if line.startswith("Disassembly of section "):
+            pending = line
+            continue
+        if not line.strip():
+            if out and out[-1]:
+                out.append("")
+            continue
+        if pending is not None:
+            if out:
+                if out[-1]:
+                    out.append("")
+                out += [pending, ""]
+            pending = None
+        out.append(line)
+    return "\n".join(out).strip("\n") + "\n" if out else ""
+
+
 def get_tool_schemas(include_final_answer: bool = True) -> list[dict]:
     if include_final_answer:
         return list(TOOL_SCHEMAS)
     return [t for t in TOOL_SCHEMAS if t["name"] != "final_answer"]
 
 
-def get_tool_schemas_for_format(file_type: str, include_final_answer: bool = True) -> list[dict]:
+def get_tool_schemas_for_format(
+    file_type: str,
+    include_final_answer: bool = True,
+    include_paging: bool = False,
+) -> list[dict]:
     """
     Return tool schemas appropriate for the given binary format.
 
     Args:
         file_type: Binary format (e.g., "ELF64", "PE32", "Mach-O")
         include_final_answer: Whether to include final_answer tool
+        include_paging: Whether to include read_more / grep_output (paged output)
 
     Returns:
         Filtered list of tool schemas
     """
     # Universal tools (work with all formats)
-    universal_tools = {"file", "strings", "hexdump", "xxd", "entropy", "final_answer"}
+    universal_tools = {"file", "strings", "section_strings", "hexdump", "xxd", "entropy", "final_answer"}
 
     # Format-specific tools
     format_specific = {
-        "ELF": {"readelf", "objdump", "nm"},
-        "ELF64": {"readelf", "objdump", "nm"},
-        "ELF32": {"readelf", "objdump", "nm"},
+        "ELF": {"readelf", "objdump", "disasm", "nm"},
+        "ELF64": {"readelf", "objdump", "disasm", "nm"},
+        "ELF32": {"readelf", "objdump", "disasm", "nm"},
         "Mach-O": {"nm"},  # nm works with MACHO; otool not available in Docker
         "Mach-O 64-bit": {"nm"},
         "PE32": {"pefile"},
@@ -594,6 +1107,8 @@ def get_tool_schemas_for_format(file_type: str, include_final_answer: bool = Tru
 
     # Filter schemas
     filtered = [s for s in TOOL_SCHEMAS if s["name"] in allowed]
+    if include_paging:
+        filtered[-1:-1] = PAGING_TOOL_SCHEMAS  # before final_answer
 
     # Optionally remove final_answer
     if not include_final_answer:
@@ -0,0 +1,141 @@
+from __future__ import annotations
+
+import gzip
+import json
+import logging
+import threading
+from pathlib import Path
+from typing import Any, Iterator
+
+log = logging.getLogger(__name__)
+
+TRANSCRIPT_FORMAT_VERSION = 1
+TRANSCRIPT_SUFFIX = ".transcript.jsonl"
+
+
+def transcript_path(transcripts_dir: Path, task_id: str, compress: bool = True) -> Path:
+    return transcripts_dir / f"{task_id}{TRANSCRIPT_SUFFIX}{'.gz' if compress else ''}"
+
+
+def find_transcript(transcripts_dir: Path, task_id: str) -> Path | None:
+    for compress in (True, False):
+        path = transcript_path(transcripts_dir, task_id, compress)
+        if path.exists():
+            return path
+    return None
+
+
+class TranscriptWriter:
+    """Append-only JSONL transcript, written as the task runs.
+
+    One JSON record per line: a "header", then "message", "step" and
+    "checkpoint" records in the order they happen, then a "summary" (or
+    "error") when the task ends. Every record is flushed as it is written,
+    so the file stays readable up to the last complete record if the process
+    dies mid-task. With `compress`, the stream is gzip and each flush is a
+    sync point.
+    """
+
+    def __init__(self, path: Path, compress: bool = True):
+        path.parent.mkdir(parents=True, exist_ok=True)
+        self.path = path
+        self._file = gzip.open(path, "wt", encoding="utf-8", compresslevel=6) if compress \
+            else open(path, "w", encoding="utf-8")
+        self._lock = threading.Lock()
+        self.records = 0
+
+    def write(self, record_type: str, **fields: Any) -> None:
+        line = json.dumps({"type": record_type, **fields}, default=str)
+        with self._lock:
+            if self._file.closed:
+                return
+            self._file.write(line + "\n")
+            self._file.flush()
+            self.records += 1
+
+    def header(self, **fields: Any) -> None:
+        self.write("header", version=TRANSCRIPT_FORMAT_VERSION, **fields)
+
+    def message(self, index: int, message: dict) -> None:
+        self.write("message", index=index, message=message)
+
+    def close(self) -> None:
+        with self._lock:
+            if not self._file.closed:
+                self._file.close()
+
+    def __enter__(self) -> "TranscriptWriter":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+
+def iter_records(path: Path) -> Iterator[dict]:
+    """Yield transcript records one at a time, without loading the file.
+
+    A transcript cut short by a crash ends at its last complete record.
+    """
+    opener = gzip.open if path.name.endswith(".gz") else open
+    with opener(path, "rt", encoding="utf-8") as f:
+        try:
+            for line in f:
+                if not line.endswith("\n"):
+                    break  # partial final line
+                yield json.loads(line)
+        except (EOFError, gzip.BadGzipFile, json.JSONDecodeError) as e:
+            log.debug("Transcript %s ends early: %s", path, e)
+
+
+def read_transcript(path: Path) -> dict[str, Any]:
+    """Load a whole transcript.
+
+    Returns {"header", "messages", "steps", "checkpoint", "summary", "error",
+    "complete"}; "checkpoint" is the last one written, and "complete" is False
+    when the task never reached its summary record.
+    """
+    transcript: dict[str, Any] = {
+        "header": {}, "messages": [], "steps": [], "checkpoint": None, "summary": None, "error": None,
+    }
+    for record in iter_records(path):
+        kind = record.pop("type", None)
+        if kind == "header":
+            transcript["header"] = record
+        elif kind == "message":
+            transcript["messages"].append(record["message"])
+        elif kind == "step":
+            transcript["steps"].append(record)
+        elif kind == "checkpoint":
+            transcript["checkpoint"] = record
+        elif kind in ("summary", "error"):
+            transcript[kind] = record
+    transcript["complete"] = transcript["summary"] is not None
+    return transcript
+
+
+def final_answer(path: Path) -> dict | None:
+    """The agent's answer: from the summary, else the last final_answer call."""
+    answer = None
+    for record in iter_records(path):
+        if record.get("type") == "summary":
+            return record.get("final_answer")
+        if record.get("type") != "message" or record["message"].get("role") != "assistant":
+            continue
+        content = record["message"].get("content")
+        for block in content if isinstance(content, list) else []:
+            if isinstance(block, dict) and block.get("type") == "tool_use" and block.get("name") == "final_answer":
+                answer = block.get("input")
+    return answer
+
+
+def tool_sequence(path: Path) -> list[dict]:
+    """[{"tool", "input"}] for every tool call in the transcript, in order."""
+    calls = []
+    for record in iter_records(path):
+        if record.get("type") != "message" or record["message"].get("role") != "assistant":
+            continue
+        content = record["message"].get("content")
+        for block in content if isinstance(content, list) else []:
+            if isinstance(block, dict) and block.get("type") == "tool_use":
+                calls.append({"tool": block.get("name"), "input": block.get("input")})
+    return calls
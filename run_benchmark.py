@@ -23,6 +23,17 @@ Custom headers for OpenAI-compatible backends:
         --openai-header "User-Agent:HELLO" \
         --openai-header "X-REASONING-EFFORT:medium" \
         --openai-header "X-OUTPUT-REASONING:true"
+
+Five trials per task, run side by side, with confidence intervals:
+    python run_benchmark.py --all --model claude-opus-4-6 --trials 5 -j 8
+
+Several models in one process, sharing the tool cache, sandboxes and connections:
+    python run_benchmark.py --all --sweep anthropic/claude-opus-4-6 openai/gpt-4o deepseek/deepseek-chat -j 8
+
+Distributed sweeps over a shared queue directory:
+    python run_benchmark.py --all --model claude-opus-4-6 --queue /shared/q --enqueue --trials 3
+    python run_benchmark.py --queue /shared/q --worker -j 4     # on each host
+    python run_benchmark.py --queue /shared/q --merge
 """
 
 import argparse
@@ -31,7 +42,9 @@ import sys
 from pathlib import Path
 
 from harness.config import BenchmarkConfig
+from harness.providers import parse_latency_model
 from harness.runner import run_benchmark
+from harness.tools import PREFETCH_DEFAULT, parse_prefetch_spec
 
 
 def main():
@@ -39,7 +52,7 @@ def main():
         description="AgentRE-Bench: Evaluate LLM agents on reverse engineering tasks",
         epilog="API keys are read from .env file in the project root (or from environment variables).",
     )
-    group = parser.add_mutually_exclusive_group(required=True)
+    group = parser.add_mutually_exclusive_group()
     group.add_argument(
         "--all",
         action="store_true",
@@ -55,8 +68,8 @@ def main():
         "--provider",
         type=str,
         default="anthropic",
-        choices=["anthropic", "openai", "openrouter", "gemini", "deepseek"],
-        help="LLM provider (default: anthropic)",
+        choices=["anthropic", "openai", "openrouter", "gemini", "deepseek", "replay"],
+        help="LLM provider; replay plays back the transcripts in the --model results directory (default: anthropic)",
     )
     parser.add_argument(
         "--model",
@@ -64,6 +77,13 @@ def main():
         default=None,
         help="Model name (default: provider-specific default)",
     )
+    parser.add_argument(
+        "--sweep",
+        nargs="+",
+        metavar="PROVIDER/MODEL",
+        help="Run several models in one process (e.g. anthropic/claude-opus-4-6 openai/gpt-4o); "
+             "each writes to <report>/<provider>_<model>, plus a combined sweep_report.json",
+    )
     parser.add_argument(
         "--api-key",
         type=str,
@@ -102,11 +122,174 @@ def main():
         default=4096,
         help="Max tokens per LLM response (default: 4096)",
     )
+    parser.add_argument(
+        "--token-budget",
+        type=int,
+        default=0,
+        help="Max input+output tokens per task; tool outputs are fitted to the remaining context (default: no limit)",
+    )
+    parser.add_argument(
+        "--context-tokens",
+        type=int,
+        default=0,
+        help="Prompt size tool outputs are fitted to (default: the provider's context window with --token-budget)",
+    )
+    parser.add_argument(
+        "--resume",
+        action="store_true",
+        help="Skip tasks already finished with the same config and continue interrupted ones from their last step",
+    )
+    parser.add_argument(
+        "--paged-output",
+        action="store_true",
+        help="Keep large tool outputs and page them to the model (adds read_more / grep_output tools)",
+    )
+    parser.add_argument(
+        "--prefetch",
+        nargs="*",
+        metavar="TOOL[:FLAGS]",
+        help=(
+            "Run common first inspections while the first model turn is in flight "
+            f"(default set: {' '.join(PREFETCH_DEFAULT)})"
+        ),
+    )
+    parser.add_argument(
+        "--stream",
+        action="store_true",
+        help="Stream provider responses (SSE) and start tool calls before the model finishes its turn",
+    )
+    parser.add_argument(
+        "--no-transcript-compression",
+        action="store_true",
+        help="Write transcripts as plain .jsonl instead of gzip-compressed .jsonl.gz",
+    )
+    parser.add_argument(
+        "--tool-parallelism",
+        type=int,
+        default=1,
+        metavar="N",
+        help="Run up to N tool calls from one model turn concurrently (default: 1)",
+    )
+    parser.add_argument(
+        "--replay-latency",
+        default="none",
+        metavar="MODEL",
+        help="With --provider replay: none (full speed), recorded, recorded*F (recorded LLM time "
+             "scaled by F) or a fixed number of seconds per turn (default: none)",
+    )
+    parser.add_argument(
+        "--no-prompt-cache",
+        action="store_true",
+        help="Disable provider prompt-prefix caching (cache breakpoints / prompt_cache_key)",
+    )
     parser.add_argument(
         "--no-docker",
         action="store_true",
         help="Run tools via subprocess instead of Docker",
     )
+    parser.add_argument(
+        "--pooled-sandbox",
+        action="store_true",
+        help="Start one sandbox container per task and run tools via docker exec",
+    )
+    parser.add_argument(
+        "--no-tool-cache",
+        action="store_true",
+        help="Disable the on-disk tool-output cache (always re-run tools)",
+    )
+    parser.add_argument(
+        "--no-index",
+        action="store_true",
+        help="Ignore build-time pre-analysis indexes (binaries/*.reidx) and always run the tools",
+    )
+    parser.add_argument(
+        "--no-analysis-server",
+        action="store_true",
+        help="Run pefile / entropy as one process per call instead of on a resident analyzer",
+    )
+    parser.add_argument(
+        "--tool-cache-dir",
+        type=str,
+        default=None,
+        help="Tool-output cache directory (default: .cache/tool_outputs)",
+    )
+    parser.add_argument(
+        "--tool-cache-max-mb",
+        type=int,
+        default=512,
+        help="Tool-output cache size cap in MB; least recently used entries are evicted (default: 512)",
+    )
+    parser.add_argument(
+        "--jobs", "-j",
+        type=int,
+        default=1,
+        help="Number of tasks to run concurrently (default: 1)",
+    )
+    parser.add_argument(
+        "--provider-concurrency",
+        type=int,
+        default=0,
+        help="Max concurrent tasks per provider (default: same as --jobs)",
+    )
+    parser.add_argument(
+        "--rpm",
+        type=int,
+        default=0,
+        help="Requests per minute allowed to the provider, shared by all tasks (default: unlimited)",
+    )
+    parser.add_argument(
+        "--tpm",
+        type=int,
+        default=0,
+        help="Prompt tokens per minute allowed to the provider, shared by all tasks (default: unlimited)",
+    )
+    parser.add_argument(
+        "--max-retries",
+        type=int,
+        default=5,
+        help="Retries on rate limits, transient 5xx and network errors before a task fails (default: 5)",
+    )
+    parser.add_argument(
+        "--queue",
+        type=str,
+        default=None,
+        metavar="DIR",
+        help="Shared work-queue directory for distributed runs (use with --enqueue, --worker or --merge)",
+    )
+    queue_mode = parser.add_mutually_exclusive_group()
+    queue_mode.add_argument(
+        "--enqueue",
+        action="store_true",
+        help="Add this run's tasks (with --all/--task) to the queue instead of running them",
+    )
+    queue_mode.add_argument(
+        "--worker",
+        action="store_true",
+        help="Run queued tasks on --jobs threads until the queue is drained",
+    )
+    queue_mode.add_argument(
+        "--merge",
+        action="store_true",
+        help="Wait for the queue to drain, then write each queued run's benchmark_report.json",
+    )
+    parser.add_argument(
+        "--trials",
+        type=int,
+        default=1,
+        help="Independent trials per task, run concurrently (or queued with --enqueue); trial N > 0 "
+             "writes to <results>/trial_N and trials_report.json holds mean, std and bootstrap CIs (default: 1)",
+    )
+    parser.add_argument(
+        "--lease-seconds",
+        type=int,
+        default=900,
+        help="Re-dispatch a queued task whose worker has not renewed its lease for this long (default: 900)",
+    )
+    parser.add_argument(
+        "--no-wait",
+        action="store_true",
+        help="With --merge: write reports from the results so far instead of waiting for the queue",
+    )
     parser.add_argument(
         "-v", "--verbose",
         action="store_true",
@@ -114,6 +297,19 @@ def main():
     )
 
     args = parser.parse_args()
+    queue_modes = args.enqueue or args.worker or args.merge
+    if queue_modes and not args.queue:
+        parser.error("--enqueue, --worker and --merge need --queue DIR")
+    if args.queue and not queue_modes:
+        parser.error("--queue needs one of --enqueue, --worker or --merge")
+    if not (args.all or args.task) and not (args.worker or args.merge):
+        parser.error("one of the arguments --all --task is required")
+    if args.sweep and (args.worker or args.merge):
+        parser.error("--sweep selects the models to run or enqueue; workers and --merge take them from the queue")
+    if args.trials < 1:
+        parser.error("--trials must be at least 1")
+    if args.trials > 1 and args.sweep and not args.queue:
+        parser.error("--trials with --sweep needs --queue DIR --enqueue")
 
     # Logging is for errors only — all user-facing output goes through print()
     logging.basicConfig(level=logging.WARNING, format="[%(levelname)s] %(message)s")
@@ -130,6 +326,17 @@ def main():
 
     project_root = Path(__file__).parent.resolve()
 
+    if args.provider == "replay":
+        if not args.model:
+            parser.error("--provider replay needs --model RESULTS_DIR (the run to play back)")
+        model = str(Path(args.model).resolve())
+        try:
+            parse_latency_model(args.replay_latency)
+        except ValueError as e:
+            parser.error(str(e))
+        if args.report and Path(args.report).resolve() == Path(model):
+            parser.error("--report must not be the replayed run's directory")
+
     # Parse custom headers for OpenAI
     custom_headers = {}
     if args.openai_headers:
@@ -140,6 +347,14 @@ def main():
             key, _, value = header.partition(":")
             custom_headers[key.strip()] = value.strip()
 
+    # --prefetch alone takes the default set
+    prefetch_tools = list(PREFETCH_DEFAULT) if args.prefetch == [] else args.prefetch or []
+    for spec in prefetch_tools:
+        try:
+            parse_prefetch_spec(spec)
+        except ValueError as e:
+            parser.error(str(e))
+
     config = BenchmarkConfig(
         project_root=project_root,
         workspace_dir=project_root / "binaries",
@@ -151,7 +366,28 @@ def main():
         openai_custom_headers=custom_headers,
         max_tool_calls=args.max_tool_calls,
         max_tokens=args.max_tokens,
+        token_budget=args.token_budget,
+        context_tokens=args.context_tokens,
+        prompt_caching=not args.no_prompt_cache,
+        streaming=args.stream,
+        tool_parallelism=args.tool_parallelism,
+        replay_latency=args.replay_latency,
+        paged_output=args.paged_output,
+        resume=args.resume,
+        compress_transcripts=not args.no_transcript_compression,
         use_docker=not args.no_docker,
+        pooled_sandbox=args.pooled_sandbox,
+        tool_cache_enabled=not args.no_tool_cache,
+        binary_index_enabled=not args.no_index,
+        analysis_server=not args.no_analysis_server,
+        prefetch_tools=prefetch_tools,
+        tool_cache_dir=Path(args.tool_cache_dir) if args.tool_cache_dir else None,
+        tool_cache_max_bytes=args.tool_cache_max_mb * 1024 * 1024,
+        jobs=args.jobs,
+        provider_concurrency=args.provider_concurrency,
+        requests_per_minute=args.rpm,
+        tokens_per_minute=args.tpm,
+        max_retries=args.max_retries,
         results_dir=Path(args.report) if args.report else None,
         verbose=args.verbose,
     )
@@ -174,8 +410,28 @@ def main():
 
     task_filter = args.task if args.task else None
 
+    configs = [config]
+    if args.sweep:
+        from harness.sweep import sweep_configs
+        try:
+            configs = sweep_configs(config, args.sweep, Path(args.report or project_root / "results").resolve())
+        except ValueError as e:
+            parser.error(str(e))
+
+    if args.queue:
+        sys.exit(_queue_main(args, configs, task_filter))
+
+    if args.sweep:
+        from harness.sweep import run_sweep
+        try:
+            run_sweep(configs, task_filter, Path(args.report or project_root / "results").resolve())
+        except Exception as e:
+            logging.getLogger(__name__).error("Sweep failed: %s", e, exc_info=True)
+            sys.exit(1)
+        return
+
     try:
-        aggregate, task_metrics, score_results = run_benchmark(config, task_filter)
+        aggregate, task_metrics, score_results = run_benchmark(config, task_filter, args.trials)
     except Exception as e:
         logging.getLogger(__name__).error("Benchmark failed: %s", e, exc_info=True)
         sys.exit(1)
@@ -186,5 +442,31 @@ def main():
     print(f"Total tokens: {aggregate.total_tokens}")
 
 
+def _queue_main(args, configs: list[BenchmarkConfig], task_filter: str | None) -> int:
+    from harness.distributed import WorkQueue, enqueue, merge, run_worker
+    from harness.runner import load_tasks
+
+    config = configs[0]
+    queue = WorkQueue(Path(args.queue), lease_seconds=args.lease_seconds)
+    if args.enqueue:
+        tasks = load_tasks(config.project_root / "tasks.json", config.project_root)
+        if task_filter:
+            tasks = [t for t in tasks if t.task_id == task_filter]
+            if not tasks:
+                print(f"Error: no task found matching {task_filter!r}", file=sys.stderr)
+                return 1
+        for config in configs:
+            run_id, added = enqueue(queue, config, tasks, args.trials)
+            print(f"Queued {added} item(s) for {config.provider}/{config.model} (run {run_id})")
+        print(f"Queue: {queue.counts()}")
+    elif args.worker:
+        done = run_worker(queue, config)
+        print(f"Worker finished: {done} task(s) completed; {queue.counts()}")
+    else:
+        reports = merge(queue, config, wait=not args.no_wait)
+        print(f"Wrote {len(reports)} report(s)")
+    return 0
+
+
 if __name__ == "__main__":
     main()
@@ -14,13 +14,20 @@ Usage:
 
     # Full benchmark (batch)
     python scorer.py -G ground_truths/ -A agent_outputs/ -r results.json
+
+    # Re-score every run under results/ (parallel, memoized)
+    python scorer.py --archive results/ -r archive.json
 """
 
 import argparse
+import hashlib
 import json
 import logging
+import os
 import re
 import sys
+import tempfile
+from concurrent.futures import ProcessPoolExecutor
 from pathlib import Path
 
 logging.basicConfig(
@@ -325,9 +332,17 @@ def load_json(path):
         return json.load(f)
 
 
+def load_agent_output(path):
+    """Agent answer from an agent_outputs/*.json file or a harness transcript."""
+    if ".transcript.jsonl" in Path(path).name:
+        from harness.transcript import final_answer
+        return final_answer(Path(path)) or {}
+    return load_json(path)
+
+
 def score_single(gt_path, agent_path):
     gt = load_json(gt_path)
-    agent = load_json(agent_path)
+    agent = load_agent_output(agent_path)
 
     sample_name = gt.get("sample", Path(gt_path).stem)
     result = score_sample(gt, agent, gt_path)
@@ -360,8 +375,9 @@ def score_batch(gt_dir, agent_dir):
         return results
 
     for gt_file in gt_files:
-        agent_file = agent_dir / gt_file.name
-        if not agent_file.exists():
+        # Also accepts a harness transcripts/ directory
+        agent_file = _agent_file(agent_dir, gt_file.stem)
+        if agent_file is None:
             log.warning("No agent output for %s, skipping", gt_file.name)
             continue
         results.append(score_single(str(gt_file), str(agent_file)))
@@ -369,6 +385,185 @@ def score_batch(gt_dir, agent_dir):
     return results
 
 
+# ===================================================================
+# Archive rescoring: many result directories, memoized
+#
+#   A score depends only on the ground truth, the agent's answer and
+#   this file (code + weights), so results are cached under the hash of
+#   all three. Re-scoring an archive recomputes only the entries whose
+#   inputs changed; answers are re-read only when their file changed.
+# ===================================================================
+SCORE_CACHE_PATH = Path(__file__).resolve().parent / ".cache" / "scores.json"
+SCORE_CACHE_VERSION = 1
+
+
+def scorer_hash():
+    return hashlib.sha256(Path(__file__).read_bytes()).hexdigest()[:16]
+
+
+def _answer_hash(answer):
+    return hashlib.sha256(json.dumps(answer, sort_keys=True, default=str).encode()).hexdigest()
+
+
+def _file_stamp(path):
+    st = os.stat(path)
+    return [st.st_size, st.st_mtime_ns]
+
+
+def _agent_file(agent_dir, sample_stem):
+    agent_file = agent_dir / f"{sample_stem}.json"
+    if agent_file.exists():
+        return agent_file
+    from harness.transcript import find_transcript
+    return find_transcript(agent_dir, sample_stem)
+
+
+def find_runs(paths):
+    """Result directories (holding agent_outputs/ or transcripts/) under `paths`."""
+    runs = set()
+    for root in paths:
+        for dirpath, dirnames, _ in os.walk(root):
+            if "agent_outputs" in dirnames or "transcripts" in dirnames:
+                runs.add(Path(dirpath).resolve())
+                # A run holds no other runs, except its --trials repetitions in trial_N/
+                dirnames[:] = [d for d in dirnames if re.fullmatch(r"trial_\d+", d)]
+    return sorted(runs)
+
+
+def _score_uncached(gt_path, agent_path):
+    """Worker: load and score one answer. Returns (answer stamp, answer hash, result)."""
+    stamp = _file_stamp(agent_path)
+    agent = load_agent_output(agent_path)
+    gt = load_json(gt_path)
+    result = score_sample(gt, agent, gt_path)
+    result["sample"] = gt.get("sample", Path(gt_path).stem)
+    return stamp, _answer_hash(agent), result
+
+
+class ScoreCache:
+    """On-disk memo: {"answers": {path: [size, mtime_ns, sha]}, "scores": {key: result}}."""
+
+    def __init__(self, path):
+        self.path = Path(path) if path else None
+        self.answers = {}
+        self.scores = {}
+        if self.path is not None and self.path.exists():
+            try:
+                data = load_json(self.path)
+                if data.get("version") == SCORE_CACHE_VERSION:
+                    self.answers = data.get("answers", {})
+                    self.scores = data.get("scores", {})
+            except (OSError, ValueError) as e:
+                log.warning("Ignoring unreadable score cache %s: %s", self.path, e)
+        self.hits = 0
+        self.misses = 0
+
+    def answer_hash(self, agent_path):
+        entry = self.answers.get(str(agent_path))
+        if entry and entry[:2] == _file_stamp(agent_path):
+            return entry[2]
+        return None
+
+    def save(self, live_keys):
+        # Entries for answers and inputs that no longer exist are dropped
+        if self.path is None:
+            return
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        data = {
+            "version": SCORE_CACHE_VERSION,
+            "answers": {p: v for p, v in self.answers.items() if os.path.exists(p)},
+            "scores": {k: v for k, v in self.scores.items() if k in live_keys},
+        }
+        fd, tmp = tempfile.mkstemp(dir=self.path.parent, suffix=".tmp")
+        with os.fdopen(fd, "w") as f:
+            json.dump(data, f)
+        os.replace(tmp, self.path)
+
+
+def score_archive(gt_dir, run_dirs, jobs=None, cache_path=SCORE_CACHE_PATH):
+    """Score every run directory against `gt_dir`. Returns ({run: results}, cache)."""
+    gt_files = sorted(Path(gt_dir).glob("*.json"))
+    gt_hashes = {f: hashlib.sha256(f.read_bytes()).hexdigest() for f in gt_files}
+    version = scorer_hash()
+    cache = ScoreCache(cache_path)
+
+    by_run = {str(run): {} for run in run_dirs}
+    pending = []   # (run, gt_file, agent_file) to score in the pool
+    live_keys = set()
+    for run in run_dirs:
+        for gt_file in gt_files:
+            agent_file = None
+            for sub in ("agent_outputs", "transcripts"):
+                if (run / sub).is_dir():
+                    agent_file = _agent_file(run / sub, gt_file.stem)
+                    if agent_file is not None:
+                        break
+            if agent_file is None:
+                continue
+            answer = cache.answer_hash(agent_file)
+            key = f"{gt_hashes[gt_file]}:{answer}:{version}" if answer else None
+            if key in cache.scores:
+                cache.hits += 1
+                live_keys.add(key)
+                by_run[str(run)][gt_file.name] = cache.scores[key]
+            else:
+                pending.append((str(run), gt_file, agent_file))
+
+    if pending:
+        with ProcessPoolExecutor(max_workers=jobs) as pool:
+            futures = [pool.submit(_score_uncached, str(g), str(a)) for _, g, a in pending]
+            for (run, gt_file, agent_file), future in zip(pending, futures):
+                try:
+                    stamp, answer, result = future.result()
+                except Exception as e:
+                    log.warning("Could not score %s: %s", agent_file, e)
+                    continue
+                cache.misses += 1
+                key = f"{gt_hashes[gt_file]}:{answer}:{version}"
+                cache.answers[str(agent_file)] = stamp + [answer]
+                cache.scores[key] = result
+                live_keys.add(key)
+                by_run[run][gt_file.name] = result
+
+    cache.save(live_keys)
+    ordered = {run: [res[f.name] for f in gt_files if f.name in res] for run, res in by_run.items()}
+    return ordered, cache
+
+
+def summarize(results):
+    standard = [r for r in results if r.get("tier") == "standard"]
+    bonus    = [r for r in results if r.get("tier") == "bonus"]
+    main_score = (
+        sum(r["final_score"] for r in standard) / len(standard)
+        if standard else 0.0
+    )
+    bonus_score = bonus[0]["final_score"] if bonus else 0.0
+    return {
+        "standard_samples": len(standard),
+        "main_score": round(main_score, 4),
+        "main_max": 1.0,
+        "bonus_score": round(bonus_score, 4),
+        "bonus_max": 1.0,
+        "total_score": round(main_score + bonus_score, 4),
+        "total_max": (1.0 if standard else 0.0) + (1.0 if bonus else 0.0),
+    }
+
+
+def print_archive_table(runs):
+    print("\n" + "=" * 76)
+    print("  ARCHIVE   main = avg of standard levels, bonus = level 13")
+    print("=" * 76)
+    print(f"  {'Run':<44} {'N':>3} {'Main':>7} {'Bonus':>7} {'Total':>7}")
+    print("  " + "-" * 72)
+    rows = sorted(runs.items(), key=lambda kv: summarize(kv[1])["total_score"], reverse=True)
+    for run, results in rows:
+        summary = summarize(results)
+        name = run if len(run) <= 44 else "..." + run[-41:]
+        print(f"  {name:<44} {len(results):>3} {summary['main_score']:>7.4f}"
+              f" {summary['bonus_score']:>7.4f} {summary['total_score']:>7.4f}")
+    print("=" * 76 + "\n")
+
+
 # ===================================================================
 # Summary output
 # ===================================================================
@@ -458,7 +653,7 @@ def main():
     )
     parser.add_argument(
         "--agent-output", "-a",
-        help="Path to a single agent output JSON file",
+        help="Path to a single agent output JSON file or harness transcript (.transcript.jsonl[.gz])",
     )
     parser.add_argument(
         "--ground-truth-dir", "-G",
@@ -466,15 +661,52 @@ def main():
     )
     parser.add_argument(
         "--agent-output-dir", "-A",
-        help="Directory of agent output JSON files (batch mode)",
+        help="Directory of agent output JSON files or harness transcripts (batch mode)",
     )
     parser.add_argument(
         "--report", "-r",
         help="Write JSON report to this path",
     )
+    parser.add_argument(
+        "--archive", "-R",
+        nargs="+",
+        metavar="DIR",
+        help="Re-score every result directory (with agent_outputs/ or transcripts/) under these paths",
+    )
+    parser.add_argument(
+        "--jobs", "-j",
+        type=int,
+        default=None,
+        help="Worker processes for --archive (default: CPU count)",
+    )
+    parser.add_argument(
+        "--no-score-cache",
+        action="store_true",
+        help=f"Recompute every score in --archive instead of reusing {SCORE_CACHE_PATH.parent.name}/{SCORE_CACHE_PATH.name}",
+    )
 
     args = parser.parse_args()
 
+    if args.archive:
+        gt_dir = args.ground_truth_dir or Path(__file__).resolve().parent / "ground_truths"
+        run_dirs = find_runs(args.archive)
+        if not run_dirs:
+            parser.error(f"No result directories found under {', '.join(args.archive)}")
+        runs, cache = score_archive(
+            gt_dir, run_dirs, args.jobs, None if args.no_score_cache else SCORE_CACHE_PATH,
+        )
+        print_archive_table(runs)
+        log.info("Scored %d runs: %d cached, %d recomputed", len(runs), cache.hits, cache.misses)
+        if args.report:
+            report = {
+                "scorer_version": scorer_hash(),
+                "runs": {run: {"results": results, "summary": summarize(results)} for run, results in runs.items()},
+            }
+            with open(args.report, "w") as f:
+                json.dump(report, f, indent=2)
+            log.info("Report written to %s", args.report)
+        return
+
     if args.ground_truth and args.agent_output:
         result = score_single(args.ground_truth, args.agent_output)
         results = [result]
@@ -490,24 +722,10 @@ def main():
     print_summary(results)
 
     if args.report:
-        standard = [r for r in results if r.get("tier") == "standard"]
-        bonus    = [r for r in results if r.get("tier") == "bonus"]
-        main_score = (
-            sum(r["final_score"] for r in standard) / len(standard)
-            if standard else 0.0
-        )
-        bonus_score = bonus[0]["final_score"] if bonus else 0.0
-
         report = {
             "results": results,
             "summary": {
-                "standard_samples": len(standard),
-                "main_score": round(main_score, 4),
-                "main_max": 1.0,
-                "bonus_score": round(bonus_score, 4),
-                "bonus_max": 1.0,
-                "total_score": round(main_score + bonus_score, 4),
-                "total_max": (1.0 if standard else 0.0) + (1.0 if bonus else 0.0),
+                **summarize(results),
                 "standard_weights": STANDARD_WEIGHTS,
                 "bonus_weights": BONUS_WEIGHTS,
                 "hallucination_penalty_standard": HALLUCINATION_PENALTY,
@@ -0,0 +1,642 @@
+#!/usr/bin/env python3
+"""
+agentre-analyzer — in-sandbox analysis helper for the AgentRE-Bench tools image.
+
+Answers the `pefile`, `entropy` and `section_strings` tools. Run once per call, or as a resident
+server that keeps each binary mmapped with its parsed section table and PE
+structures, so repeated calls skip interpreter startup, the pefile import and
+re-parsing. Entropy goes to the native agentre-entropy helper when it is on
+PATH (its output kept per binary and options); the Python version here is the
+fallback for hosts without it.
+
+    agentre-analyzer pefile {headers|sections|imports|exports|resources|all} <path>
+    agentre-analyzer entropy [-w window] [-s step] [-j section] [-S] <path>
+    agentre-analyzer strings [-n min] [-e ascii|utf16|both] [-j section]... [-D] <path>
+    agentre-analyzer --serve
+
+`entropy` takes the agentre-entropy options and prints the same output. In
+server mode each stdin line is a JSON request {"argv": [...], "limit": chars,
+"timeout": seconds} and each stdout line the JSON result {"stdout", "stderr",
+"returncode", "output_bytes", "stopped_early", "timed_out"}. The server exits
+at end of input.
+"""
+
+import bisect
+import contextlib
+import getopt
+import io
+import json
+import math
+import mmap
+import os
+import re
+import shutil
+import signal
+import struct
+import subprocess
+import sys
+from collections import Counter, OrderedDict
+
+ENTROPY_HELPER = "agentre-entropy"
+PEFILE_FLAGS = ("headers", "sections", "imports", "exports", "resources", "all")
+MAX_LISTED_WINDOWS = 50
+MIN_WINDOW_BYTES = 16
+MAX_CACHED_BINARIES = 8
+STRING_ENCODINGS = ("ascii", "utf16", "both")
+MAX_STRING_CHARS = 200
+
+_NATIVE_ENTROPY = shutil.which(ENTROPY_HELPER)
+
+
+class ToolError(Exception):
+    """Printed to stderr; the call exits with `returncode`."""
+
+    def __init__(self, message, returncode=1):
+        super().__init__(message)
+        self.returncode = returncode
+
+
+class Binary:
+    """One mmapped file; section table, PE object and entropies parsed on first use."""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            size = os.fstat(f.fileno()).st_size
+            self.data = mmap.mmap(f.fileno(), size, access=mmap.ACCESS_READ) if size else b""
+        self._sections = None
+        self._pe = None
+        self._entropy = {}
+        self._strings = {}
+        self.outputs = {}     # native helper results by argv
+
+    def close(self):
+        if self._pe is not None:
+            self._pe.close()
+        if isinstance(self.data, mmap.mmap):
+            self.data.close()
+
+    def sections(self):
+        if self._sections is None:
+            self._sections = parse_sections(self.data)
+        return self._sections
+
+    def entropy(self, offset, size):
+        key = (offset, size)
+        if key not in self._entropy:
+            self._entropy[key] = entropy_of(self.data[offset:offset + size])
+        return self._entropy[key]
+
+    def strings(self, min_len, encoding):
+        """[(offset, text, "A" or "W")] over the whole file, in file order."""
+        key = (min_len, encoding)
+        if key not in self._strings:
+            self._strings[key] = scan_strings(self.data, min_len, encoding)
+        return self._strings[key]
+
+    def pe(self):
+        if self._pe is None:
+            import pefile
+            self._pe = pefile.PE(self.path)
+        return self._pe
+
+
+_binaries = OrderedDict()
+
+
+def load(path):
+    """The cached Binary for `path`, reloaded when the file changes."""
+    try:
+        st = os.stat(path)
+    except OSError as e:
+        raise ToolError(f"Error: {path}: {e.strerror}")
+    key = (path, st.st_size, st.st_mtime_ns)
+    binary = _binaries.pop(key, None)
+    if binary is None:
+        binary = Binary(path)
+        for stale in [k for k in _binaries if k[0] == path]:
+            _binaries.pop(stale).close()
+    _binaries[key] = binary
+    while len(_binaries) > MAX_CACHED_BINARIES:
+        _binaries.popitem(last=False)[1].close()
+    return binary
+
+
+# ── Entropy (mirrors tools/entropy.c) ─────────────────────────────────
+
+def histogram(data):
+    counts = Counter(data)
+    return [counts.get(b, 0) for b in range(256)]
+
+
+def entropy_of(data):
+    n = len(data)
+    if n == 0:
+        return 0.0
+    ent = 0.0
+    inv = 1.0 / n
+    # Summed in byte order, as the helper does, so the rounded output matches
+    for _, count in sorted(Counter(data).items()):
+        p = count * inv
+        ent -= p * math.log2(p)
+    return ent
+
+
+def round4(x):
+    r = round(x * 10000.0) / 10000.0
+    return r if r > 0.0 else 0.0
+
+
+def windows_chunked(data, window):
+    out = []
+    for i in range(0, len(data), window):
+        chunk = data[i:i + window]
+        if len(chunk) < MIN_WINDOW_BYTES:
+            break
+        out.append((i, len(chunk), round4(entropy_of(chunk))))
+    return out
+
+
+def windows_sliding(data, window, step):
+    n = len(data)
+    if n < window:
+        return [(0, n, round4(entropy_of(data)))] if n >= MIN_WINDOW_BYTES else []
+    clogc = [0.0] + [c * math.log2(c) for c in range(1, window + 1)]
+    hist = histogram(data[:window])
+    s = sum(clogc[c] for c in hist)
+    log2w = math.log2(window)
+    invw = 1.0 / window
+    out = []
+    start = 0
+    while True:
+        out.append((start, window, round4(log2w - s * invw)))
+        if start + step + window > n:
+            break
+        for j in range(step):
+            gone = data[start + j]
+            come = data[start + window + j]
+            if gone == come:
+                continue
+            s += clogc[hist[gone] - 1] - clogc[hist[gone]]
+            hist[gone] -= 1
+            s += clogc[hist[come] + 1] - clogc[hist[come]]
+            hist[come] += 1
+        start += step
+    return out
+
+
+def _cstr(raw):
+    return raw.split(b"\x00", 1)[0].decode("latin-1")
+
+
+def _add_section(out, name, offset, size, file_size, addr=0):
+    if offset > file_size:
+        return
+    out.append((name[:63], offset, min(size, file_size - offset), addr))
+
+
+def parse_elf(d):
+    n = len(d)
+    if n < 64:
+        raise ToolError("Error: malformed section table")
+    if d[5] != 1:
+        raise ToolError("Only little-endian ELF supported for section targeting")
+    is64 = d[4] == 2
+    if is64:
+        shoff, = struct.unpack_from("<Q", d, 40)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", d, 58)
+    else:
+        shoff, = struct.unpack_from("<I", d, 32)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", d, 46)
+    out = []
+    if shnum == 0:
+        return out
+    if shoff + shnum * shentsize > n or shstrndx >= shnum:
+        raise ToolError("Error: malformed section table")
+
+    def header(i):
+        sh = shoff + i * shentsize
+        if is64:
+            name, kind = struct.unpack_from("<II", d, sh)
+            addr, off, size = struct.unpack_from("<QQQ", d, sh + 16)
+        else:
+            name, kind = struct.unpack_from("<II", d, sh)
+            addr, off, size = struct.unpack_from("<III", d, sh + 12)
+        return name, kind, off, size, addr
+
+    _, _, stroff, strsize, _ = header(shstrndx)
+    if stroff + strsize > n:
+        raise ToolError("Error: malformed section table")
+    strtab = d[stroff:stroff + strsize]
+    for i in range(shnum):
+        name_idx, kind, off, size, addr = header(i)
+        if kind == 0 or name_idx >= strsize:   # SHT_NULL
+            continue
+        # SHT_NOBITS (.bss, .tbss) occupies no file bytes
+        _add_section(out, _cstr(strtab[name_idx:]), off, 0 if kind == 8 else size, n, addr)
+    return out
+
+
+def parse_pe(d):
+    n = len(d)
+    if n < 0x40:
+        raise ToolError("Error: malformed section table")
+    pe, = struct.unpack_from("<I", d, 0x3c)
+    if pe + 24 > n or d[pe:pe + 4] != b"PE\x00\x00":
+        raise ToolError("Error: malformed section table")
+    nsect, = struct.unpack_from("<H", d, pe + 6)
+    opt_size, = struct.unpack_from("<H", d, pe + 20)
+    table = pe + 24 + opt_size
+    if table + nsect * 40 > n:
+        raise ToolError("Error: malformed section table")
+    # ImageBase: 8 bytes at +24 in a PE32+ optional header, 4 at +28 in PE32
+    image_base = 0
+    if opt_size >= 32:
+        magic, = struct.unpack_from("<H", d, pe + 24)
+        image_base, = struct.unpack_from("<Q", d, pe + 48) if magic == 0x20b else struct.unpack_from("<I", d, pe + 52)
+    out = []
+    for i in range(nsect):
+        s = table + i * 40
+        rva, raw_size, raw_offset = struct.unpack_from("<III", d, s + 12)
+        _add_section(out, _cstr(d[s:s + 8]), raw_offset, raw_size, n, image_base + rva)
+    return out
+
+
+def parse_macho(d):
+    n = len(d)
+    if n < 28:
+        raise ToolError("Error: malformed section table")
+    is64 = struct.unpack_from("<I", d, 0)[0] == 0xfeedfacf
+    ncmds, = struct.unpack_from("<I", d, 16)
+    p = 32 if is64 else 28
+    out = []
+    for _ in range(ncmds):
+        if p + 8 > n:
+            raise ToolError("Error: malformed section table")
+        cmd, cmdsize = struct.unpack_from("<II", d, p)
+        if cmdsize < 8 or p + cmdsize > n:
+            raise ToolError("Error: malformed section table")
+        if cmd in (0x19, 0x1):   # LC_SEGMENT_64, LC_SEGMENT
+            seg64 = cmd == 0x19
+            hdr, sect_size = (72, 80) if seg64 else (56, 68)
+            if cmdsize < hdr:
+                raise ToolError("Error: malformed section table")
+            nsects, = struct.unpack_from("<I", d, p + (64 if seg64 else 48))
+            if hdr + nsects * sect_size > cmdsize:
+                raise ToolError("Error: malformed section table")
+            for s in range(nsects):
+                sec = p + hdr + s * sect_size
+                addr, size = struct.unpack_from("<QQ" if seg64 else "<II", d, sec + 32)
+                offset, = struct.unpack_from("<I", d, sec + (48 if seg64 else 40))
+                flags, = struct.unpack_from("<I", d, sec + (64 if seg64 else 56))
+                # S_ZEROFILL / S_GB_ZEROFILL / S_THREAD_LOCAL_ZEROFILL
+                if flags & 0xff in (0x1, 0xc, 0x12):
+                    size = 0
+                name = f"{_cstr(d[sec + 16:sec + 32])},{_cstr(d[sec:sec + 16])}"
+                _add_section(out, name, offset, size, n, addr)
+        p += cmdsize
+    return out
+
+
+def parse_sections(d):
+    if d[:4] == b"\x7fELF":
+        return parse_elf(d)
+    if d[:2] == b"MZ":
+        return parse_pe(d)
+    if len(d) >= 4 and struct.unpack_from("<I", d, 0)[0] in (0xfeedfacf, 0xfeedface):
+        return parse_macho(d)
+    raise ToolError("Error: not an ELF, PE or Mach-O file")
+
+
+def find_section(sections, want):
+    for s in sections:
+        # Mach-O sections may also be named without the segment prefix
+        if s[0] == want or ("," in s[0] and s[0].split(",", 1)[1] == want):
+            return s
+    return None
+
+
+def bar(ent):
+    return "#" * int(ent * 4)
+
+
+def print_windows(binary, offset, size, window, step):
+    data = binary.data[offset:offset + size]
+    w = windows_chunked(data, window) if step >= window else windows_sliding(data, window, step)
+    print(f"Total size: {size} bytes")
+    print(f"Overall entropy: {binary.entropy(offset, size):.4f} bits/byte")
+    print(f"Window size: {window} bytes")
+    if step < window:
+        print(f"Window step: {step} bytes")
+    print(f"Windows analyzed: {len(w)}")
+    print()
+    if w:
+        ents = [e for _, _, e in w]
+        print(f"Min window entropy: {min(ents):.4f}")
+        print(f"Max window entropy: {max(ents):.4f}")
+        print(f"Avg window entropy: {sum(ents) / len(ents):.4f}")
+        print()
+        print("Offset      Size  Entropy")
+        print("-" * 35)
+        for off, length, ent in w[:MAX_LISTED_WINDOWS]:
+            print(f"0x{off:08x}  {length:4d}  {ent:.4f}  {bar(ent)}")
+        if len(w) > MAX_LISTED_WINDOWS:
+            print(f"... ({len(w) - MAX_LISTED_WINDOWS} more windows)")
+
+
+def print_section_table(binary, sections):
+    n = len(binary.data)
+    print(f"Total size: {n} bytes")
+    print(f"Overall entropy: {binary.entropy(0, n):.4f} bits/byte")
+    print(f"Sections analyzed: {len(sections)}")
+    print()
+    print(f"{'Section':<24} {'Offset':<10}  {'Size':>10}  Entropy")
+    print("-" * 60)
+    for name, offset, size, _ in sections:
+        line = f"{name:<24} 0x{offset:08x}  {size:10d}  "
+        if size == 0:
+            print(line + "   -")
+            continue
+        ent = binary.entropy(offset, size)
+        print(f"{line}{ent:.4f}  {bar(ent)}")
+
+
+def cmd_entropy(argv):
+    usage = "usage: agentre-entropy [-w window] [-s step] [-j section] [-S] <path>"
+    try:
+        opts, rest = getopt.getopt(argv, "w:s:j:S")
+    except getopt.GetoptError:
+        raise ToolError(usage, 2)
+    if len(rest) != 1:
+        raise ToolError(usage, 2)
+    window, step, section, per_section = 256, 0, None, False
+    for opt, value in opts:
+        if opt == "-w":
+            window = int(value)
+        elif opt == "-s":
+            step = int(value)
+        elif opt == "-j":
+            section = value or None
+        else:
+            per_section = True
+    if window <= 0:
+        raise ToolError("Error: window size must be positive", 2)
+    step = step or window
+
+    binary = load(rest[0])
+    if _NATIVE_ENTROPY:
+        # The native helper beats the Python below by far; run it once per
+        # binary and option set and answer repeats from memory
+        key = tuple(argv)
+        if key not in binary.outputs:
+            proc = subprocess.run([_NATIVE_ENTROPY, *argv], capture_output=True, text=True)
+            binary.outputs[key] = (proc.stdout, proc.stderr, proc.returncode)
+        stdout, stderr, returncode = binary.outputs[key]
+        sys.stdout.write(stdout)
+        sys.stderr.write(stderr)
+        return returncode
+
+    if per_section:
+        print_section_table(binary, binary.sections())
+    elif section:
+        found = find_section(binary.sections(), section)
+        if found is None:
+            raise ToolError(f"Section '{section}' not found")
+        print_windows(binary, found[1], found[2], window, step)
+    else:
+        print_windows(binary, 0, len(binary.data), window, step)
+    return 0
+
+
+# ── Strings ───────────────────────────────────────────────────────────
+
+_PRINTABLE = rb"[\x20-\x7e\t]"
+
+
+def scan_strings(data, min_len, encoding):
+    """ASCII and/or UTF-16LE runs of printable characters, found in one regex pass."""
+    patterns = []
+    if encoding in ("utf16", "both"):
+        patterns.append(rb"(?:%s\x00){%d,}" % (_PRINTABLE, min_len))
+    if encoding in ("ascii", "both"):
+        patterns.append(rb"%s{%d,}" % (_PRINTABLE, min_len))
+    out = []
+    for m in re.finditer(b"|".join(patterns), data):
+        raw = m.group()
+        if b"\x00" in raw:
+            out.append((m.start(), raw[::2].decode("ascii"), "W"))
+        else:
+            out.append((m.start(), raw.decode("ascii"), "A"))
+    return out
+
+
+def section_at(sections, starts, offset):
+    """The section holding file `offset` (sections sorted by offset), or None."""
+    i = bisect.bisect_right(starts, offset) - 1
+    if i >= 0 and offset < sections[i][1] + sections[i][2]:
+        return sections[i]
+    return None
+
+
+def cmd_strings(argv):
+    usage = "usage: agentre-analyzer strings [-n min] [-e ascii|utf16|both] [-j section]... [-D] <path>"
+    try:
+        opts, rest = getopt.getopt(argv, "n:e:j:D")
+    except getopt.GetoptError:
+        raise ToolError(usage, 2)
+    if len(rest) != 1:
+        raise ToolError(usage, 2)
+    min_len, encoding, wanted, dedupe = 4, "both", [], True
+    for opt, value in opts:
+        if opt == "-n":
+            min_len = int(value)
+        elif opt == "-e":
+            encoding = value
+        elif opt == "-j":
+            wanted.append(value)
+        else:
+            dedupe = False
+    if min_len < 1 or encoding not in STRING_ENCODINGS:
+        raise ToolError(usage, 2)
+
+    binary = load(rest[0])
+    try:
+        sections = sorted((s for s in binary.sections() if s[2]), key=lambda s: s[1])
+    except ToolError:
+        sections = []   # not a parseable object file: strings still work, unattributed
+    only = None
+    if wanted:
+        only = set()
+        for name in wanted:
+            found = find_section(sections, name)
+            if found is None:
+                names = ", ".join(s[0] for s in sections) or "none"
+                raise ToolError(f"Section '{name}' not found (sections with file data: {names})")
+            only.add(found[0])
+    starts = [s[1] for s in sections]
+
+    rows, seen, counts = [], {}, Counter()
+    for offset, text, enc in binary.strings(min_len, encoding):
+        section = section_at(sections, starts, offset)
+        name = section[0] if section else "-"
+        if only is not None and name not in only:
+            continue
+        if dedupe and text in seen:
+            seen[text][4] += 1
+            continue
+        addr = section[3] + offset - section[1] if section and section[3] else None
+        row = [offset, addr, name, enc, 1, text]
+        rows.append(row)
+        counts[name] += 1
+        if dedupe:
+            seen[text] = row
+
+    total = sum(row[4] for row in rows)
+    kind = {"both": "ASCII + UTF-16LE", "ascii": "ASCII", "utf16": "UTF-16LE"}[encoding]
+    print(f"{total} strings" + (f", {len(rows)} unique" if dedupe else "") + f" ({kind}, min length {min_len})")
+    if counts:
+        print("By section: " + ", ".join(f"{name} {n}" for name, n in counts.most_common()))
+    print()
+    print(f"{'Offset':<10}  {'Address':<18}  {'Section':<20} Enc  String")
+    for offset, addr, name, enc, seen_count, text in rows:
+        text = text.replace("\t", "\\t")
+        if len(text) > MAX_STRING_CHARS:
+            text = f"{text[:MAX_STRING_CHARS]}... [{len(text):,} chars]"
+        where = f"0x{addr:x}" if addr is not None else "-"
+        repeat = f"  (x{seen_count})" if seen_count > 1 else ""
+        print(f"0x{offset:08x}  {where:<18}  {name:<20} {enc:<3}  {text}{repeat}")
+    return 0
+
+
+# ── pefile ────────────────────────────────────────────────────────────
+
+def cmd_pefile(argv):
+    if len(argv) != 2 or argv[0] not in PEFILE_FLAGS:
+        raise ToolError(f"usage: agentre-analyzer pefile {{{'|'.join(PEFILE_FLAGS)}}} <path>", 2)
+    flags, path = argv
+    try:
+        pe = load(path).pe()
+        if flags in ("headers", "all"):
+            print("=== DOS HEADER ===")
+            print(pe.DOS_HEADER)
+            print("\n=== NT HEADERS ===")
+            print(pe.NT_HEADERS)
+            print("\n=== OPTIONAL HEADER ===")
+            print(pe.OPTIONAL_HEADER)
+
+        if flags in ("sections", "all"):
+            print("\n=== SECTIONS ===")
+            for section in pe.sections:
+                print(f"{section.Name.decode().rstrip(chr(0))}:")
+                print(f"  Virtual Address: 0x{section.VirtualAddress:x}")
+                print(f"  Virtual Size: 0x{section.Misc_VirtualSize:x}")
+                print(f"  Raw Size: 0x{section.SizeOfRawData:x}")
+                print(f"  Characteristics: 0x{section.Characteristics:x}")
+
+        if flags in ("imports", "all"):
+            print("\n=== IMPORTS ===")
+            if hasattr(pe, "DIRECTORY_ENTRY_IMPORT"):
+                for entry in pe.DIRECTORY_ENTRY_IMPORT:
+                    print(f"{entry.dll.decode()}:")
+                    for imp in entry.imports:
+                        if imp.name:
+                            print(f"  {imp.name.decode()}")
+
+        if flags in ("exports", "all"):
+            print("\n=== EXPORTS ===")
+            if hasattr(pe, "DIRECTORY_ENTRY_EXPORT"):
+                for exp in pe.DIRECTORY_ENTRY_EXPORT.symbols:
+                    print(f"  {exp.name.decode() if exp.name else 'ordinal=' + str(exp.ordinal)}")
+
+        if flags in ("resources", "all"):
+            print("\n=== RESOURCES ===")
+            if hasattr(pe, "DIRECTORY_ENTRY_RESOURCE"):
+                print("Resource directory present")
+    except ToolError:
+        raise
+    except Exception as e:
+        raise ToolError(f"Error: {e}")
+    return 0
+
+
+COMMANDS = {"entropy": cmd_entropy, "pefile": cmd_pefile, "strings": cmd_strings}
+
+
+def run(argv):
+    """Run one command against the current stdout/stderr; returns its exit code."""
+    if not argv or argv[0] not in COMMANDS:
+        print(f"usage: agentre-analyzer {{{'|'.join(COMMANDS)}}} ... | --serve", file=sys.stderr)
+        return 2
+    try:
+        return COMMANDS[argv[0]](argv[1:])
+    except ToolError as e:
+        print(e, file=sys.stderr)
+        return e.returncode
+
+
+# ── Server ────────────────────────────────────────────────────────────
+
+class _Timeout(BaseException):
+    pass
+
+
+def _alarm(signum, frame):
+    raise _Timeout()
+
+
+def _text(buf):
+    # Same newline handling as the harness's subprocess capture
+    return buf.getvalue().replace("\r\n", "\n").replace("\r", "\n")
+
+
+def handle(request):
+    argv = [str(a) for a in request.get("argv", [])]
+    limit = int(request.get("limit", 0)) or None
+    out, err = io.StringIO(), io.StringIO()
+    timed_out = False
+    signal.alarm(max(1, int(request.get("timeout", 30))))
+    try:
+        with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+            returncode = run(argv)
+    except _Timeout:
+        timed_out, returncode = True, -1
+    finally:
+        signal.alarm(0)
+    stdout, stderr = _text(out), _text(err)
+    stopped_early = limit is not None and len(stdout) > limit
+    return {
+        # One char past the limit, so the harness truncates (and marks) it as for a killed tool
+        "stdout": stdout[:limit + 1] if stopped_early else stdout,
+        "stderr": stderr[:limit + 1] if limit is not None else stderr,
+        "returncode": -signal.SIGKILL if stopped_early else returncode,
+        "output_bytes": len(stdout.encode("utf-8")) + len(stderr.encode("utf-8")),
+        "stopped_early": stopped_early,
+        "timed_out": timed_out,
+    }
+
+
+def serve():
+    signal.signal(signal.SIGALRM, _alarm)
+    # The protocol owns the real stdout; tool output goes to per-request buffers
+    channel = sys.stdout
+    for line in sys.stdin:
+        if not line.strip():
+            continue
+        try:
+            response = handle(json.loads(line))
+        except (ValueError, TypeError) as e:
+            response = {"stdout": "", "stderr": f"Error: bad request: {e}", "returncode": 2,
+                        "output_bytes": 0, "stopped_early": False, "timed_out": False}
+        channel.write(json.dumps(response) + "\n")
+        channel.flush()
+    return 0
+
+
+def main():
+    if sys.argv[1:] == ["--serve"]:
+        return serve()
+    return run(sys.argv[1:])
+
+
+if __name__ == "__main__":
+    sys.exit(main())
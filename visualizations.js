@@ -10,6 +10,7 @@ class ComparisonDataset {
     this.models = [];
     this.taskLookup = new Map();
     this.aggregateLookup = new Map();
+    this.pendingDetails = new Map();  // run_id → { model, resolve }
   }
 
   loadFromEmbedded() {
@@ -21,6 +22,13 @@ class ComparisonDataset {
 
     try {
       this.models = JSON.parse(dataElement.textContent);
+      this.models.forEach(model => {
+        if (model.detail && typeof model.detail === 'object') {
+          model.task_metrics = model.detail.task_metrics;
+          model.score_results = model.detail.score_results;
+          model.detailApplied = true;
+        }
+      });
       this._buildLookups();
       return true;
     } catch (error) {
@@ -52,6 +60,48 @@ class ComparisonDataset {
     return this.models;
   }
 
+  // Task details (full metrics rows, field scores, tool sequences) are kept
+  // out of the page: `detail` is either the object itself (--self-contained)
+  // or the path of a script that calls agentreBenchDetail(runId, detail).
+  isDetailLoaded(modelId) {
+    const model = this.models[modelId];
+    return !model || !model.detail || Boolean(model.detailApplied);
+  }
+
+  loadDetail(modelId) {
+    const model = this.models[modelId];
+    if (this.isDetailLoaded(modelId)) return Promise.resolve();
+    if (!model.detailPromise) {
+      model.detailPromise = new Promise((resolve, reject) => {
+        this.pendingDetails.set(model.run_id, { model, resolve });
+        const script = document.createElement('script');
+        script.src = model.detail;
+        script.onerror = () => {
+          model.detailPromise = null;
+          reject(new Error(`Could not load ${model.detail}`));
+        };
+        document.head.appendChild(script);
+      });
+    }
+    return model.detailPromise;
+  }
+
+  receiveDetail(runId, detail) {
+    const pending = this.pendingDetails.get(runId);
+    if (!pending) return;
+    this.pendingDetails.delete(runId);
+    pending.model.detail = detail;
+    this._applyDetail(pending.model, detail);
+    pending.resolve();
+  }
+
+  _applyDetail(model, detail) {
+    model.task_metrics = detail.task_metrics;
+    model.score_results = detail.score_results;
+    model.detailApplied = true;
+    this._buildLookups();
+  }
+
   getTasksByLevel() {
     // Return tasks sorted by level 1-13
     const allTasks = Array.from(this.taskLookup.keys());
@@ -82,6 +132,9 @@ class ComparisonDataset {
 // Global dataset instance
 const dataset = new ComparisonDataset();
 
+// Entry point of the lazily loaded <output>_data/run_*.js files
+window.agentreBenchDetail = (runId, detail) => dataset.receiveDetail(runId, detail);
+
 // ═══════════════════════════════════════════════════════════════════════════
 // Chart Renderers
 // ═══════════════════════════════════════════════════════════════════════════
@@ -611,6 +664,16 @@ class ModelDetailView {
       return '<div class="loading">Model not found</div>';
     }
 
+    if (!dataset.isDetailLoaded(modelId)) {
+      dataset.loadDetail(modelId)
+        .then(() => router.handleRoute())
+        .catch(error => {
+          document.getElementById('app').innerHTML =
+            `<div class="loading">Failed to load task details: ${error.message}</div>`;
+        });
+      return '<div class="loading">Loading task details...</div>';
+    }
+
     const tasks = dataset.getTaskMetricsForModel(model.label);
     const agg = model.aggregate_metrics;
 
@@ -623,6 +686,7 @@ class ModelDetailView {
 
         ${this._renderConfigPanel(model.config)}
         ${this._renderAggregateMetrics(agg)}
+        ${this._renderPhaseTimings(agg.phase_timings)}
 
         <div class="chart-container">
           <div style="display: flex; justify-content: space-between; align-items: center; margin-bottom: 16px;">
@@ -731,6 +795,51 @@ class ModelDetailView {
     `;
   }
 
+  _renderPhaseTimings(timings) {
+    // Older reports have no phase_timings; percentiles are pooled over all tasks
+    if (!timings || Object.keys(timings).length === 0) return '';
+    return `
+      <div class="task-table-wrapper">
+        <h2 class="chart-title" style="padding: 16px 16px 0;">Phase Latency</h2>
+        ${this._renderPhaseTable(timings)}
+      </div>
+    `;
+  }
+
+  _renderPhaseTable(timings) {
+    const fmt = seconds => seconds >= 1 ? `${seconds.toFixed(2)}s` : `${(seconds * 1000).toFixed(0)}ms`;
+    const rows = Object.entries(timings).map(([phase, t]) => `
+      <tr>
+        <td>${phase}</td>
+        <td>${t.count}</td>
+        <td>${fmt(t.total)}</td>
+        <td>${fmt(t.p50)}</td>
+        <td>${fmt(t.p95)}</td>
+        <td>${fmt(t.p99)}</td>
+        <td>${fmt(t.max)}</td>
+      </tr>
+    `).join('');
+
+    return `
+      <table class="task-table">
+        <thead>
+          <tr>
+            <th>Phase</th>
+            <th>Count</th>
+            <th>Total</th>
+            <th>p50</th>
+            <th>p95</th>
+            <th>p99</th>
+            <th>Max</th>
+          </tr>
+        </thead>
+        <tbody>
+          ${rows}
+        </tbody>
+      </table>
+    `;
+  }
+
   _renderTaskTable(tasks) {
     const rows = tasks.map((task, index) => {
       const level = task.task_id.match(/level(\d+)/)?.[1] || '?';
@@ -789,6 +898,16 @@ class ModelDetailView {
         <div class="field-scores">
           ${fieldScores}
         </div>
+        ${task.tool_sequence ? `
+          <h4 style="margin: 16px 0 8px; color: var(--text);">Tool Calls</h4>
+          <div style="color: var(--text-dim); font-size: 0.85rem; font-family: monospace;">
+            ${task.tool_sequence.join(' → ')}
+          </div>
+        ` : ''}
+        ${task.phase_timings && Object.keys(task.phase_timings).length ? `
+          <h4 style="margin: 16px 0 8px; color: var(--text);">Phase Latency</h4>
+          ${this._renderPhaseTable(task.phase_timings)}
+        ` : ''}
         ${task.error_occurred ? `
           <div style="margin-top: 16px; padding: 12px; background: rgba(239, 68, 68, 0.1); border: 1px solid var(--red); border-radius: 6px; color: var(--text-dim); font-size: 0.85rem;">
             <strong style="color: var(--red);">Error:</strong> ${task.error_message || 'Unknown error'}
@@ -800,7 +919,7 @@ class ModelDetailView {
 
   afterRender(modelId) {
     const model = dataset.getModels()[modelId];
-    if (!model) return;
+    if (!model || !dataset.isDetailLoaded(modelId)) return;
 
     // Initial render with single model
     chartRenderer.renderTaskProgression('task-progression-chart', model.label);